@@ -6,6 +6,9 @@
 # and compiler), you can override by setting LUA_VERSION=5.1 when invoking
 # make.
 #
+# LuaJIT is used when asked for with LUA_VERSION=jit. It implements the
+# Lua 5.1 API and has no luac, so build/luajitc wraps 'luajit -b' instead.
+#
 # If successful, sets the following variables:
 #  * LUA_VERSION (unless already set)
 #  * LUA_LIBS (can be appended to LDFLAGS directly)
@@ -24,6 +27,21 @@ pathsearch = $(firstword $(wildcard $(addsuffix /$(1),$(subst :, ,$(PATH)))))
 # Extract "5.x" from lua -v
 lua_ver_extract = $(shell $1 -v 2>&1 | cut -f2 -d' ' | cut -f-2 -d.)
 
+ifeq ($(LUA_VERSION),jit)
+
+ifeq ($(filter luajit,$(shell pkg-config --list-all | cut -f1 -d' ')),)
+$(error LUA_VERSION=jit was given but pkg-config does not know luajit)
+endif
+
+LUA_LIBS=	$(shell pkg-config --libs luajit)
+LUA_INCLUDES=	$(shell pkg-config --cflags luajit)
+LUA=		$(call pathsearch,luajit)
+LUAC=		$(abspath $(TOPDIR))/build/luajitc
+
+$(info >> Using LuaJIT $(shell pkg-config --modversion luajit), binary $(LUA))
+
+else
+
 # Lua does not provide an official .pc file, so finding one at all is tricky,
 # and there won't be any guarantees it looks the same as elsewhere.
 # We try the package names lua$(ver), lua-$(ver) for all candidate versions in
@@ -73,6 +91,8 @@ ifneq ($(call lua_ver_match_bin,$(LUA_VERSION),$(LUAC)),1)
 $(error $(LUAC) should be $(LUA_VERSION) but is $(call lua_ver_extract,$(LUAC)))
 endif
 
+endif # LUA_VERSION=jit
+
 endif
 
 # this is necessary, otherwise the rest of the build process keeps calling
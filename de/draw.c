@@ -22,9 +22,9 @@
 /*{{{ Colour group lookup */
 
 
-static DEColourGroup *destyle_get_colour_group2(DEStyle *style,
-                                                const GrStyleSpec *a1,
-                                                const GrStyleSpec *a2)
+static DEColourGroup *destyle_score_colour_group2(DEStyle *style,
+                                                  const GrStyleSpec *a1,
+                                                  const GrStyleSpec *a2)
 {
     int i, score, maxscore=0;
     DEColourGroup *maxg=&(style->cgrp);
@@ -45,6 +45,110 @@ static DEColourGroup *destyle_get_colour_group2(DEStyle *style,
 }
 
 
+/* The result of the lookup only depends on the exact attributes and scores
+ * of a1 and a2, and the colour groups of the style and the styles it is
+ * based on, which do not change after the style has been defined. Hence
+ * the result can be memoised per style.
+ */
+
+static uint cgrp_memo_hash(const GrStyleSpec *a1, const GrStyleSpec *a2)
+{
+    ulong h=0;
+
+    if(a1!=NULL)
+        h=gr_stylespec_hash(a1, h);
+
+    /* Separate a1 and a2 so that attributes can't move between them. */
+    h=h*31+1;
+
+    if(a2!=NULL)
+        h=gr_stylespec_hash(a2, h);
+
+    return (uint)((h^(h>>15))%DE_CGRP_MEMO_SIZE);
+}
+
+
+static bool cgrp_memo_spec_eq(const GrStyleSpec *m, const GrStyleSpec *a)
+{
+    /* A NULL spec scores the same as an empty one. */
+    if(a==NULL)
+        return (m->n==0);
+
+    return gr_stylespec_equals_scored(m, a);
+}
+
+
+static void cgrp_memo_clear(DECGrpMemo *m)
+{
+    gr_stylespec_unalloc(&m->a1);
+    gr_stylespec_unalloc(&m->a2);
+    m->cgrp=NULL;
+}
+
+
+static void cgrp_memo_set(DECGrpMemo *m, const GrStyleSpec *a1,
+                          const GrStyleSpec *a2, DEColourGroup *cgrp)
+{
+    cgrp_memo_clear(m);
+
+    if((a1!=NULL && !gr_stylespec_append(&m->a1, a1)) ||
+       (a2!=NULL && !gr_stylespec_append(&m->a2, a2))){
+        cgrp_memo_clear(m);
+        return;
+    }
+
+    m->cgrp=cgrp;
+}
+
+
+void destyle_flush_cgrp_memo(DEStyle *style)
+{
+    int i;
+
+    if(style->cgrp_memo==NULL)
+        return;
+
+    for(i=0; i<DE_CGRP_MEMO_SIZE; i++)
+        cgrp_memo_clear(style->cgrp_memo+i);
+
+    free(style->cgrp_memo);
+    style->cgrp_memo=NULL;
+}
+
+
+static DEColourGroup *destyle_get_colour_group2(DEStyle *style,
+                                                const GrStyleSpec *a1,
+                                                const GrStyleSpec *a2)
+{
+    DEColourGroup *cgrp;
+    DECGrpMemo *m;
+
+    if(style->cgrp_memo==NULL){
+        /* No point memoising styles without extra colour groups */
+        if(style->n_extra_cgrps==0 && style->based_on==NULL)
+            return &(style->cgrp);
+
+        style->cgrp_memo=ALLOC_N(DECGrpMemo, DE_CGRP_MEMO_SIZE);
+
+        if(style->cgrp_memo==NULL)
+            return destyle_score_colour_group2(style, a1, a2);
+    }
+
+    m=style->cgrp_memo+cgrp_memo_hash(a1, a2);
+
+    if(m->cgrp!=NULL && cgrp_memo_spec_eq(&m->a1, a1)
+       && cgrp_memo_spec_eq(&m->a2, a2)){
+        return m->cgrp;
+    }
+
+    cgrp=destyle_score_colour_group2(style, a1, a2);
+
+    cgrp_memo_set(m, a1, a2, cgrp);
+
+    return cgrp;
+}
+
+
 DEColourGroup *debrush_get_colour_group2(DEBrush *brush,
                                          const GrStyleSpec *a1,
                                          const GrStyleSpec *a2)
@@ -8,8 +8,13 @@
  */
 
 #include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <libtu/objp.h>
+#include <libextl/extl.h>
+#include <libextl/readconfig.h>
 #include <ioncore/common.h>
 #include <ioncore/log.h>
 #include "font.h"
@@ -21,10 +26,251 @@
 #endif /* HAVE_X11_BMF */
 #include "brush.h"
 
+
+/*{{{ Font resolution cache */
+
+
+#ifdef HAVE_X11_XFT
+
+/* Maps Xft font names to the fully resolved patterns fontconfig matched
+ * them to, so that the (slow) matching can be skipped on later loads,
+ * also across restarts. The match also depends on the Xft resources, the
+ * screen resolution and the fontconfig setup, so the saved cache carries
+ * a stamp of those and is dropped when it does not match.
+ */
+static ExtlTab font_cache;
+static bool font_cache_loaded=FALSE;
+static bool font_cache_dirty=FALSE;
+static char font_cache_stamp[32];
+
+
+static const char *font_cache_resources[]={
+    "dpi", "scale", "antialias", "hinting", "hintstyle", "autohint",
+    "rgba", "lcdfilter", "embolden", NULL
+};
+
+
+static ulong stamp_str(ulong h, const char *str)
+{
+    while(*str!='\0')
+        h=h*31+(uchar)*str++;
+
+    return h*31;
+}
+
+
+static ulong stamp_files(ulong h, FcStrList *list)
+{
+    FcChar8 *file;
+    struct stat st;
+
+    if(list==NULL)
+        return h;
+
+    while((file=FcStrListNext(list))!=NULL){
+        h=stamp_str(h, (const char*)file);
+        if(stat((const char*)file, &st)==0)
+            h=h*31+(ulong)st.st_mtime;
+    }
+
+    FcStrListDone(list);
+
+    return h;
+}
+
+
+static void get_font_cache_stamp(char *buf, size_t size)
+{
+    Display *dpy=ioncore_g.dpy;
+    int scr=DefaultScreen(dpy);
+    const char *val;
+    ulong h=0;
+    int i;
+
+    for(i=0; font_cache_resources[i]!=NULL; i++){
+        val=XGetDefault(dpy, "Xft", font_cache_resources[i]);
+        h=stamp_str(h, (val!=NULL ? val : ""));
+    }
+
+    /* Xft falls back to this without an Xft.dpi resource. */
+    h=h*31+(ulong)DisplayHeight(dpy, scr);
+    h=h*31+(ulong)DisplayHeightMM(dpy, scr);
+
+    /* Fonts added to or removed from the font directories also change
+     * what fontconfig matches.
+     */
+    h=stamp_files(h, FcConfigGetConfigFiles(NULL));
+    h=stamp_files(h, FcConfigGetFontDirs(NULL));
+
+    snprintf(buf, size, "%d:%lx", FcGetVersion(), h);
+}
+
+
+static XftFont *open_cached_font(const char *name)
+{
+    FcPattern *pat;
+    FcChar8 *file;
+    XftFont *font;
+    char *resolved;
+
+    if(!font_cache_loaded || !extl_table_gets_s(font_cache, name, &resolved))
+        return NULL;
+
+    pat=FcNameParse((FcChar8*)resolved);
+    free(resolved);
+
+    if(pat==NULL)
+        goto drop;
+
+    /* The font may have been uninstalled since. */
+    if(FcPatternGetString(pat, FC_FILE, 0, &file)==FcResultMatch &&
+       access((const char*)file, R_OK)!=0){
+        FcPatternDestroy(pat);
+        goto drop;
+    }
+
+    /* On success, the pattern is owned by the font. */
+    font=XftFontOpenPattern(ioncore_g.dpy, pat);
+
+    if(font!=NULL){
+        LOG(DEBUG, FONT, "Font %s found in cache", name);
+        return font;
+    }
+
+    FcPatternDestroy(pat);
+
+drop:
+    extl_table_clears(font_cache, name);
+    font_cache_dirty=TRUE;
+    return NULL;
+}
+
+
+static XftFont *open_font(const char *name)
+{
+    XftFont *font=open_cached_font(name);
+    FcChar8 *resolved;
+
+    if(font!=NULL)
+        return font;
+
+    font=XftFontOpenName(ioncore_g.dpy, DefaultScreen(ioncore_g.dpy), name);
+
+    if(font!=NULL && font_cache_loaded){
+        resolved=FcNameUnparse(font->pattern);
+        if(resolved!=NULL){
+            extl_table_sets_s(font_cache, name, (const char*)resolved);
+            font_cache_dirty=TRUE;
+            free(resolved);
+        }
+    }
+
+    return font;
+}
+
+#endif /* HAVE_X11_XFT */
+
+
+void de_load_font_cache()
+{
+#ifdef HAVE_X11_XFT
+    ExtlTab tab;
+    char *stamp;
+    bool found=FALSE;
+
+    if(font_cache_loaded)
+        return;
+
+    get_font_cache_stamp(font_cache_stamp, sizeof(font_cache_stamp));
+
+    font_cache=extl_table_none();
+
+    if(extl_read_savefile("saved_fontcache", &tab)){
+        found=TRUE;
+        if(extl_table_gets_s(tab, "stamp", &stamp)){
+            if(strcmp(stamp, font_cache_stamp)==0)
+                extl_table_gets_t(tab, "fonts", &font_cache);
+            free(stamp);
+        }
+        extl_unref_table(tab);
+    }
+
+    if(font_cache==extl_table_none()){
+        font_cache=extl_create_table();
+        /* Replace a stale cache even if no fonts are resolved. */
+        font_cache_dirty=found;
+    }else{
+        font_cache_dirty=FALSE;
+    }
+
+    font_cache_loaded=(font_cache!=extl_table_none());
+#endif /* HAVE_X11_XFT */
+}
+
+
+void de_save_font_cache()
+{
+#ifdef HAVE_X11_XFT
+    ExtlTab tab;
+
+    if(!font_cache_loaded || !font_cache_dirty)
+        return;
+
+    tab=extl_create_table();
+    extl_table_sets_s(tab, "stamp", font_cache_stamp);
+    extl_table_sets_t(tab, "fonts", font_cache);
+
+    if(extl_write_savefile("saved_fontcache", tab))
+        font_cache_dirty=FALSE;
+
+    extl_unref_table(tab);
+#endif /* HAVE_X11_XFT */
+}
+
+
+void de_deinit_font_cache()
+{
+#ifdef HAVE_X11_XFT
+    if(!font_cache_loaded)
+        return;
+
+    de_save_font_cache();
+    extl_unref_table(font_cache);
+    font_cache_loaded=FALSE;
+#endif /* HAVE_X11_XFT */
+}
+
+
+/*EXTL_DOC
+ * Forget the resolved Xft font patterns saved in the session directory.
+ * Fonts loaded after this are matched through fontconfig again; useful
+ * after installing or configuring fonts.
+ */
+EXTL_EXPORT
+void de_clear_font_cache()
+{
+#ifdef HAVE_X11_XFT
+    if(!font_cache_loaded)
+        return;
+
+    extl_unref_table(font_cache);
+    font_cache=extl_create_table();
+    font_cache_loaded=(font_cache!=extl_table_none());
+    font_cache_dirty=TRUE;
+    de_save_font_cache();
+#endif /* HAVE_X11_XFT */
+}
+
+
+/*}}}*/
+
+
 /*{{{ Load/free */
 
 
-static DEFont *fonts=NULL;
+#define DE_FONT_HASH_SIZE 31
+
+static DEFont *font_hash[DE_FONT_HASH_SIZE];
 
 
 const char *de_default_fontname()
@@ -35,7 +281,97 @@ const char *de_default_fontname()
         return "fixed";
 }
 
+
+/* Strip surrounding and collapse repeated white space, and lowercase XLFD
+ * names, which the X server matches case-insensitively.
+ */
+static char *normalize_fontname(const char *fontname)
+{
+    char *name=ALLOC_N(char, strlen(fontname)+1), *p;
+    bool xlfd, ws=FALSE;
+
+    if(name==NULL)
+        return NULL;
+
+    while(isspace((uchar)*fontname))
+        fontname++;
+
+    xlfd=(strncmp(fontname, "xft:", 4)!=0);
+
+    for(p=name; *fontname!='\0'; fontname++){
+        if(isspace((uchar)*fontname)){
+            ws=TRUE;
+            continue;
+        }
+        if(ws){
+            *p++=' ';
+            ws=FALSE;
+        }
+        *p++=(xlfd ? tolower((uchar)*fontname) : *fontname);
+    }
+
+    *p='\0';
+
+    return name;
+}
+
+
+static ulong hash_fontname(const char *name)
+{
+    ulong h=0;
+
+    while(*name!='\0')
+        h=h*31+(uchar)*name++;
+
+    return h;
+}
+
+
+static DEFont *find_font(const char *name, ulong h)
+{
+    DEFont *fnt;
+
+    for(fnt=font_hash[h%DE_FONT_HASH_SIZE]; fnt!=NULL; fnt=fnt->next){
+        if(fnt->hash==h && strcmp(fnt->pattern, name)==0)
+            return fnt;
+    }
+
+    return NULL;
+}
+
+
+static DEFont *do_load_font(const char *fontname, ulong h);
+
+
 DEFont *de_load_font(const char *fontname)
+{
+    DEFont *fnt;
+    char *name;
+    ulong h;
+
+    assert(fontname!=NULL);
+
+    name=normalize_fontname(fontname);
+
+    if(name==NULL)
+        return NULL;
+
+    h=hash_fontname(name);
+
+    fnt=find_font(name, h);
+
+    if(fnt!=NULL)
+        fnt->refcount++;
+    else
+        fnt=do_load_font(name, h);
+
+    free(name);
+
+    return fnt;
+}
+
+
+static DEFont *do_load_font(const char *fontname, ulong h)
 {
     DEFont *fnt;
     const char *default_fontname=de_default_fontname();
@@ -47,20 +383,10 @@ DEFont *de_load_font(const char *fontname)
     XFontStruct *fontstruct=NULL;
 #endif
 
-    assert(fontname!=NULL);
-
-    /* There shouldn't be that many fonts... */
-    for(fnt=fonts; fnt!=NULL; fnt=fnt->next){
-        if(strcmp(fnt->pattern, fontname)==0){
-            fnt->refcount++;
-            return fnt;
-        }
-    }
-
 #ifdef HAVE_X11_XFT
     LOG(DEBUG, FONT, "Loading font %s via XFT", fontname);
     if(strncmp(fontname, "xft:", 4)==0){
-        font=XftFontOpenName(ioncore_g.dpy, DefaultScreen(ioncore_g.dpy), fontname+4);
+        font=open_font(fontname+4);
     }else{
 #ifdef HAVE_X11_BMF
         goto bitmap_font;
@@ -135,11 +461,12 @@ bitmap_font:
     fnt->fontstruct=fontstruct;
 #endif
     fnt->pattern=scopy(fontname);
+    fnt->hash=h;
     fnt->next=NULL;
     fnt->prev=NULL;
     fnt->refcount=1;
 
-    LINK_ITEM(fonts, fnt, next, prev);
+    LINK_ITEM(font_hash[h%DE_FONT_HASH_SIZE], fnt, next, prev);
 
     return fnt;
 }
@@ -202,7 +529,7 @@ void de_free_font(DEFont *font)
     if(font->pattern!=NULL)
         free(font->pattern);
 
-    UNLINK_ITEM(fonts, font, next, prev);
+    UNLINK_ITEM(font_hash[font->hash%DE_FONT_HASH_SIZE], font, next, prev);
     free(font);
 }
 
@@ -27,6 +27,7 @@ INTRSTRUCT(DEFont);
 
 DECLSTRUCT(DEFont){
     char *pattern;
+    ulong hash;
     int refcount;
 #ifdef HAVE_X11_BMF
     XFontSet fontset;
@@ -44,6 +45,10 @@ extern bool de_set_font_for_style(DEStyle *style, DEFont *font);
 extern DEFont *de_load_font(const char *fontname);
 extern void de_free_font(DEFont *font);
 
+extern void de_load_font_cache();
+extern void de_save_font_cache();
+extern void de_deinit_font_cache();
+
 extern void debrush_draw_string(DEBrush *brush, int x, int y,
                                 const char *str, int len, bool needfill);
 extern void debrush_do_draw_string(DEBrush *brush, int x, int y,
@@ -10,6 +10,7 @@
 
 #include <libextl/readconfig.h>
 #include <libextl/extl.h>
+#include <libmainloop/hooks.h>
 
 #include <ioncore/common.h>
 #include <ioncore/global.h>
@@ -183,6 +184,8 @@ void de_get_extra_cgrps(WRootWin *rootwin, DEStyle *style, ExtlTab tab)
     uint i=0, nfailed=0, n=extl_table_get_n(tab);
     ExtlTab sub;
 
+    destyle_flush_cgrp_memo(style);
+
     if(n==0)
         return;
 
@@ -437,6 +440,9 @@ bool de_init()
     if(!gr_register_engine("de", (GrGetBrushFn*)&de_get_brush))
         goto fail;
 
+    de_load_font_cache();
+    hook_add(ioncore_snapshot_hook, de_save_font_cache);
+
     /* Create fallback brushes */
     FOR_ALL_ROOTWINS(rootwin){
         style=de_create_style(rootwin, "*");
@@ -459,6 +465,8 @@ void de_deinit()
     gr_unregister_engine("de");
     de_unregister_exports();
     de_deinit_styles();
+    hook_remove(ioncore_snapshot_hook, de_save_font_cache);
+    de_deinit_font_cache();
 }
 
 
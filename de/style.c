@@ -116,26 +116,177 @@ void destyle_create_tab_gcs(DEStyle *style)
 
 static DEStyle *styles=NULL;
 
+/* Styles are indexed by their leading (highest-scored non-star) attribute:
+ * a style can only match a spec that contains that attribute. Styles
+ * consisting of stars only are always candidates.
+ */
+#define DE_STYLE_INDEX_SIZE 64
 
-DEStyle *de_get_style(WRootWin *rootwin, const GrStyleSpec *spec)
+static DEStyle *style_index[DE_STYLE_INDEX_SIZE];
+static DEStyle *star_styles=NULL;
+static ulong style_serial=0;
+
+/* Resolved lookups, flushed whenever the set of styles changes. */
+#define DE_STYLE_CACHE_SIZE 64
+
+typedef struct{
+    bool used;
+    WRootWin *rootwin;
+    GrStyleSpec spec;
+    DEStyle *style;
+} DEStyleCacheEntry;
+
+static DEStyleCacheEntry style_cache[DE_STYLE_CACHE_SIZE];
+
+
+static uint attr_bucket(GrAttr a)
+{
+    ulong h=(ulong)a>>3;
+
+    return (uint)((h^(h>>7))%DE_STYLE_INDEX_SIZE);
+}
+
+
+static GrAttr leading_attr(const GrStyleSpec *spec)
+{
+    static GrAttr star_id=GRATTR_NONE;
+    GrAttr a=GRATTR_NONE;
+    uint i, maxscore=0;
+
+    if(star_id==GRATTR_NONE)
+        star_id=stringstore_alloc("*");
+
+    for(i=0; i<spec->n; i++){
+        if(spec->attrs[i].attr!=star_id && spec->attrs[i].score>maxscore){
+            a=spec->attrs[i].attr;
+            maxscore=spec->attrs[i].score;
+        }
+    }
+
+    return a;
+}
+
+
+static void flush_style_cache()
+{
+    int i;
+
+    for(i=0; i<DE_STYLE_CACHE_SIZE; i++){
+        if(style_cache[i].used){
+            gr_stylespec_unalloc(&style_cache[i].spec);
+            style_cache[i].used=FALSE;
+        }
+    }
+}
+
+
+static void link_style(DEStyle *style)
+{
+    style->serial=++style_serial;
+    style->index_attr=leading_attr(&style->spec);
+
+    LINK_ITEM_FIRST(styles, style, next, prev);
+
+    if(style->index_attr==GRATTR_NONE){
+        LINK_ITEM(star_styles, style, index_next, index_prev);
+    }else{
+        uint b=attr_bucket(style->index_attr);
+        LINK_ITEM(style_index[b], style, index_next, index_prev);
+    }
+
+    flush_style_cache();
+}
+
+
+static void unlink_style(DEStyle *style)
+{
+    UNLINK_ITEM(styles, style, next, prev);
+
+    if(style->index_attr==GRATTR_NONE){
+        UNLINK_ITEM(star_styles, style, index_next, index_prev);
+    }else{
+        uint b=attr_bucket(style->index_attr);
+        UNLINK_ITEM(style_index[b], style, index_next, index_prev);
+    }
+
+    flush_style_cache();
+}
+
+
+static void score_candidates(DEStyle *list, WRootWin *rootwin,
+                             const GrStyleSpec *spec,
+                             DEStyle **maxstyle, int *maxscore)
 {
-    DEStyle *style, *maxstyle=NULL;
-    int score, maxscore=0;
+    DEStyle *style;
+    int score;
 
-    for(style=styles; style!=NULL; style=style->next){
+    for(style=list; style!=NULL; style=style->index_next){
         if(style->rootwin!=rootwin)
             continue;
         score=gr_stylespec_score(&style->spec, spec);
-        if(score>maxscore){
-            maxstyle=style;
-            maxscore=score;
+        /* On ties, prefer the most recently defined style, as the
+         * style list is ordered that way.
+         */
+        if(score>*maxscore ||
+           (score==*maxscore && score>0 && style->serial>(*maxstyle)->serial)){
+            *maxstyle=style;
+            *maxscore=score;
         }
     }
+}
+
+
+static DEStyle *do_get_style(WRootWin *rootwin, const GrStyleSpec *spec)
+{
+    DEStyle *maxstyle=NULL;
+    int maxscore=0;
+    uint i;
+
+    score_candidates(star_styles, rootwin, spec, &maxstyle, &maxscore);
+
+    /* A bucket may get scanned more than once, but that does not change
+     * the result.
+     */
+    for(i=0; i<spec->n; i++){
+        score_candidates(style_index[attr_bucket(spec->attrs[i].attr)],
+                         rootwin, spec, &maxstyle, &maxscore);
+    }
 
     return maxstyle;
 }
 
 
+DEStyle *de_get_style(WRootWin *rootwin, const GrStyleSpec *spec)
+{
+    DEStyleCacheEntry *ent;
+    ulong h;
+
+    h=gr_stylespec_hash(spec, (ulong)rootwin>>3);
+    ent=&style_cache[(h^(h>>15))%DE_STYLE_CACHE_SIZE];
+
+    if(ent->used && ent->rootwin==rootwin &&
+       gr_stylespec_equals_scored(&ent->spec, spec)){
+        return ent->style;
+    }
+
+    if(ent->used){
+        gr_stylespec_unalloc(&ent->spec);
+        ent->used=FALSE;
+    }
+
+    ent->style=do_get_style(rootwin, spec);
+
+    if(gr_stylespec_append(&ent->spec, spec)){
+        ent->rootwin=rootwin;
+        ent->used=TRUE;
+    }else{
+        gr_stylespec_unalloc(&ent->spec);
+    }
+
+    return ent->style;
+}
+
+
 /*}}}*/
 
 
@@ -156,7 +307,7 @@ void destyle_deinit(DEStyle *style)
 {
     int i;
 
-    UNLINK_ITEM(styles, style, next, prev);
+    unlink_style(style);
 
     gr_stylespec_unalloc(&style->spec);
 
@@ -174,6 +325,8 @@ void destyle_deinit(DEStyle *style)
     if(style->extra_cgrps!=NULL)
         free(style->extra_cgrps);
 
+    destyle_flush_cgrp_memo(style);
+
     extl_unref_table(style->data_table);
 
     XFreeGC(ioncore_g.dpy, style->normal_gc);
@@ -196,7 +349,7 @@ void destyle_deinit(DEStyle *style)
 static void dump_style(DEStyle *style)
 {
     /* Allow the style still be used but get if off the list. */
-    UNLINK_ITEM(styles, style, next, prev);
+    unlink_style(style);
     destyle_unref(style);
 }
 
@@ -217,6 +370,11 @@ bool destyle_init(DEStyle *style, WRootWin *rootwin, const char *name)
     style->based_on=NULL;
 
     style->usecount=1;
+
+    style->next=style->prev=NULL;
+    style->index_next=style->index_prev=NULL;
+    style->index_attr=GRATTR_NONE;
+    style->serial=0;
     /* Fallback brushes are not released on de_reset() */
     style->is_fallback=FALSE;
 
@@ -246,6 +404,7 @@ bool destyle_init(DEStyle *style, WRootWin *rootwin, const char *name)
 
     style->n_extra_cgrps=0;
     style->extra_cgrps=NULL;
+    style->cgrp_memo=NULL;
 
     style->data_table=extl_table_none();
 
@@ -289,7 +448,7 @@ DEStyle *de_create_style(WRootWin *rootwin, const char *name)
     if(oldstyle!=NULL && !oldstyle->is_fallback)
         dump_style(oldstyle);
 
-    LINK_ITEM_FIRST(styles, style, next, prev);
+    link_style(style);
 
     return style;
 }
@@ -322,6 +481,7 @@ void de_deinit_styles()
         }
         dump_style(style);
     }
+    flush_style_cache();
 }
 
 
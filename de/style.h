@@ -17,6 +17,7 @@
 
 INTRSTRUCT(DEBorder);
 INTRSTRUCT(DEStyle);
+INTRSTRUCT(DECGrpMemo);
 
 #include "font.h"
 #include "colour.h"
@@ -49,6 +50,15 @@ DECLSTRUCT(DEBorder){
 };
 
 
+/* Number of slots in the per-style colour group lookup memo. */
+#define DE_CGRP_MEMO_SIZE 32
+
+DECLSTRUCT(DECGrpMemo){
+    GrStyleSpec a1, a2;
+    DEColourGroup *cgrp;
+};
+
+
 DECLSTRUCT(DEStyle){
     GrStyleSpec spec;
     int usecount;
@@ -65,6 +75,7 @@ DECLSTRUCT(DEStyle){
     DEColourGroup cgrp;
     int n_extra_cgrps;
     DEColourGroup *extra_cgrps;
+    DECGrpMemo *cgrp_memo;
     GrTransparency transparency_mode;
     DEFont *font;
     int textalign;
@@ -82,6 +93,11 @@ DECLSTRUCT(DEStyle){
     int tag_pixmap_h;
 
     DEStyle *next, *prev;
+
+    /* Lookup index; see style.c */
+    ulong serial;
+    GrAttr index_attr;
+    DEStyle *index_next, *index_prev;
 };
 
 
@@ -91,6 +107,7 @@ extern DEStyle *de_create_style(WRootWin *rootwin, const char *name);
 extern void destyle_unref(DEStyle *style);
 
 extern void destyle_create_tab_gcs(DEStyle *style);
+extern void destyle_flush_cgrp_memo(DEStyle *style);
 
 extern void de_reset();
 extern void de_deinit_styles();
@@ -172,10 +172,76 @@ void binding_deinit(WBinding *binding)
         binding->label=NULL;
     }
 
+    if(binding->action!=NULL){
+        binding_action_destroy(binding->action);
+        binding->action=NULL;
+    }
+
     binding->func=extl_unref_fn(binding->func);
 }
 
 
+void binding_action_destroy(WBindingAction *action)
+{
+    int i;
+
+    for(i=0; i<action->nargs; i++){
+        if(action->src[i]==BINDING_ARG_STR)
+            free((char*)action->args[i].s);
+    }
+
+    if(action->guard_cls!=NULL)
+        free(action->guard_cls);
+
+    extl_free_direct(&action->fn);
+
+    free(action);
+}
+
+
+/* Returns FALSE if the action can not be called directly now, in which
+ * case the binding's function should be called instead.
+ */
+bool binding_action_call(WBindingAction *action, WRegion *reg,
+                         WRegion *sub, WRegion *chld)
+{
+    ExtlL2Param in[BINDING_ACTION_MAX_ARGS], out[1];
+    WRegion *g;
+    int i;
+
+    if(!extl_direct_ok(&action->fn))
+        return FALSE;
+
+    if(action->guard_src!=BINDING_ARG_NONE){
+        g=(action->guard_src==BINDING_ARG_SUB ? sub : chld);
+        if(g==NULL)
+            return TRUE;
+        if(action->guard_cls!=NULL && !obj_is_str((Obj*)g, action->guard_cls))
+            return TRUE;
+    }
+
+    for(i=0; i<action->nargs; i++){
+        switch(action->src[i]){
+        case BINDING_ARG_REG:
+            in[i].o=(Obj*)reg;
+            break;
+        case BINDING_ARG_SUB:
+            in[i].o=(Obj*)sub;
+            break;
+        case BINDING_ARG_CHLD:
+            in[i].o=(Obj*)chld;
+            break;
+        default:
+            in[i]=action->args[i];
+        }
+    }
+
+    extl_call_direct(&action->fn, in, out);
+
+    return TRUE;
+}
+
+
 static void do_destroy_binding(WBinding *binding)
 {
     assert(binding!=NULL);
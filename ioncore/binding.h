@@ -29,11 +29,38 @@
 #define FOR_ALL_BINDINGS(B, NODE, MAP) \
         rb_traverse(NODE, MAP) if(((B)=(WBinding*)rb_val(NODE))!=NULL)
 
+#define BINDING_ACTION_MAX_ARGS 8
+
+/* Sources of the arguments to a WBindingAction. */
+enum{
+    BINDING_ARG_NONE,
+    BINDING_ARG_CONST,
+    BINDING_ARG_STR,            /* constant string owned by the action */
+    BINDING_ARG_REG,            /* _ */
+    BINDING_ARG_SUB,            /* _sub */
+    BINDING_ARG_CHLD            /* _chld */
+};
+
 INTRSTRUCT(WBinding);
+INTRSTRUCT(WBindingAction);
 INTRSTRUCT(WBindmap);
 INTRSTRUCT(WRegBindingInfo);
 
 
+/* A binding whose command just calls an exported function with constant
+ * arguments or those the binding was called with, to be called without
+ * entering Lua.
+ */
+DECLSTRUCT(WBindingAction){
+    ExtlDirectFn fn;
+    int nargs;
+    int src[BINDING_ACTION_MAX_ARGS];
+    ExtlL2Param args[BINDING_ACTION_MAX_ARGS];
+    int guard_src;
+    char *guard_cls;
+};
+
+
 DECLSTRUCT(WBinding){
     uint kcb; /* keycode or button */
     uint ksb; /* keysym or button */
@@ -43,6 +70,7 @@ DECLSTRUCT(WBinding){
     bool wait;
     WBindmap *submap;
     ExtlFn func;
+    WBindingAction *action;
     const char *doc;
     const char *label;
 };
@@ -88,6 +116,9 @@ extern WBinding *bindmap_lookup_binding_area(WBindmap *bindmap, int act,
                                      uint state, uint kcb, int area);
 
 extern void binding_deinit(WBinding *binding);
+extern void binding_action_destroy(WBindingAction *action);
+extern bool binding_action_call(WBindingAction *action, WRegion *reg,
+                                WRegion *sub, WRegion *chld);
 extern void binding_grab_on(const WBinding *binding, Window win);
 extern void binding_ungrab_on(const WBinding *binding, Window win);
 
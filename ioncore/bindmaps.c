@@ -221,6 +221,7 @@ WBindmap *ioncore_create_cycle_bindmap(uint kcb, uint state,
     b.wait=FALSE;
     b.submap=NULL;
     b.func=extl_ref_fn(cycle);
+    b.action=NULL;
     b.doc=NULL;
     b.label=NULL;
 
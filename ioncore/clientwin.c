@@ -1089,27 +1089,20 @@ static void clientwin_size_hints(WClientWin *cwin, WSizeHints *hints_ret)
 /*{{{ Identity & lookup */
 
 
-/*EXTL_DOC
- * Returns a table containing the properties \code{WM_CLASS} (table entries
- * \var{instance} and \var{class}) and  \code{WM_WINDOW_ROLE} (\var{role})
- * properties for \var{cwin}. If a property is not set, the corresponding
- * field(s) are unset in the  table.
+/* Fills 'id' from the window's WM_CLASS, WM_WINDOW_ROLE and related
+ * properties. Unset strings are NULL. Free with clientwin_ident_deinit.
  */
-EXTL_SAFE
-EXTL_EXPORT_MEMBER
-ExtlTab clientwin_get_ident(WClientWin *cwin)
+void clientwin_ident_init(WClientWin *cwin, WClientWinIdent *id)
 {
-    char **p=NULL, **p2=NULL, *wrole=NULL;
+    char **p=NULL, **p2=NULL;
     int n=0, n2=0, n3=0;
     Window tforwin=None;
-    ExtlTab tab;
-    bool dockapp_hack=FALSE;
 
     p=xwindow_get_text_property(cwin->win, XA_WM_CLASS, &n);
 
     p2=xwindow_get_text_property(cwin->win, ioncore_g.atom_dockapp_hack, &n2);
 
-    dockapp_hack=(n2>0);
+    id->is_dockapp=(n2>0);
 
     if(p==NULL){
         /* Some dockapps do actually have WM_CLASS, so use it. */
@@ -1118,31 +1111,68 @@ ExtlTab clientwin_get_ident(WClientWin *cwin)
         p2=NULL;
     }
 
-    wrole=xwindow_get_string_property(cwin->win, ioncore_g.atom_wm_window_role,
-                                      &n3);
-
-    tab=extl_create_table();
-    if(n>=2 && p[1]!=NULL)
-        extl_table_sets_s(tab, "class", p[1]);
-    if(n>=1 && p[0]!=NULL)
-        extl_table_sets_s(tab, "instance", p[0]);
-    if(wrole!=NULL)
-        extl_table_sets_s(tab, "role", wrole);
+    id->role=xwindow_get_string_property(cwin->win,
+                                         ioncore_g.atom_wm_window_role, &n3);
 
-    if(XGetTransientForHint(ioncore_g.dpy, cwin->win, &tforwin)
-       && tforwin!=None){
-        extl_table_sets_b(tab, "is_transient", TRUE);
-    }
+    id->cls=(n>=2 && p[1]!=NULL ? scopy(p[1]) : NULL);
+    id->instance=(n>=1 && p[0]!=NULL ? scopy(p[0]) : NULL);
 
-    if(dockapp_hack)
-        extl_table_sets_b(tab, "is_dockapp", TRUE);
+    id->is_transient=(XGetTransientForHint(ioncore_g.dpy, cwin->win, &tforwin)
+                      && tforwin!=None);
 
     if(p!=NULL)
         XFreeStringList(p);
     if(p2!=NULL)
         XFreeStringList(p2);
-    if(wrole!=NULL)
-        free(wrole);
+}
+
+
+void clientwin_ident_deinit(WClientWinIdent *id)
+{
+    if(id->cls!=NULL)
+        free(id->cls);
+    if(id->instance!=NULL)
+        free(id->instance);
+    if(id->role!=NULL)
+        free(id->role);
+}
+
+
+ExtlTab clientwin_ident_table(const WClientWinIdent *id)
+{
+    ExtlTab tab=extl_create_table();
+
+    if(id->cls!=NULL)
+        extl_table_sets_s(tab, "class", id->cls);
+    if(id->instance!=NULL)
+        extl_table_sets_s(tab, "instance", id->instance);
+    if(id->role!=NULL)
+        extl_table_sets_s(tab, "role", id->role);
+    if(id->is_transient)
+        extl_table_sets_b(tab, "is_transient", TRUE);
+    if(id->is_dockapp)
+        extl_table_sets_b(tab, "is_dockapp", TRUE);
+
+    return tab;
+}
+
+
+/*EXTL_DOC
+ * Returns a table containing the properties \code{WM_CLASS} (table entries
+ * \var{instance} and \var{class}) and  \code{WM_WINDOW_ROLE} (\var{role})
+ * properties for \var{cwin}. If a property is not set, the corresponding
+ * field(s) are unset in the  table.
+ */
+EXTL_SAFE
+EXTL_EXPORT_MEMBER
+ExtlTab clientwin_get_ident(WClientWin *cwin)
+{
+    WClientWinIdent id;
+    ExtlTab tab;
+
+    clientwin_ident_init(cwin, &id);
+    tab=clientwin_ident_table(&id);
+    clientwin_ident_deinit(&id);
 
     return tab;
 }
@@ -1355,6 +1385,8 @@ static ExtlTab clientwin_get_configuration(WClientWin *cwin)
         xwindow_set_integer_property(cwin->win, ioncore_g.atom_checkcode,
                                      chkc);
         extl_table_sets_i(tab, "checkcode", chkc);
+        /* Configurations saved earlier have the old checkcode. */
+        region_conf_changed((WRegion*)cwin);
     }
 
     ioncore_get_sm_callbacks(&add_cb, &cfg_cb);
@@ -44,6 +44,17 @@
 
 #define CLIENTWIN_SET_INPUT         0x400000
 
+INTRSTRUCT(WClientWinIdent);
+
+DECLSTRUCT(WClientWinIdent){
+    char *cls;
+    char *instance;
+    char *role;
+    bool is_transient;
+    bool is_dockapp;
+};
+
+
 DECLCLASS(WClientWin){
     WRegion region;
 
@@ -83,6 +94,10 @@ extern void clientwin_tfor_changed(WClientWin *cwin);
 
 extern void clientwin_get_set_name(WClientWin *cwin);
 
+extern void clientwin_ident_init(WClientWin *cwin, WClientWinIdent *id);
+extern void clientwin_ident_deinit(WClientWinIdent *id);
+extern ExtlTab clientwin_ident_table(const WClientWinIdent *id);
+
 extern void clientwin_handle_configure_request(WClientWin *cwin,
                                                XConfigureRequestEvent *ev);
 
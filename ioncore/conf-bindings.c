@@ -7,6 +7,7 @@
  */
 
 #include <string.h>
+#include <ctype.h>
 
 #define XK_MISCELLANY
 #include <X11/keysymdef.h>
@@ -155,11 +156,252 @@ bool ioncore_parse_keybut(const char *str, uint *mod_ret, uint *ksb_ret,
 /*}}}*/
 
 
+/*{{{ Native actions */
+
+
+/* Commands of the form "Mod.fn(args)" or "fn(args)", where fn is an
+ * exported function and each argument is _, _sub, _chld, nil, true,
+ * false, a number or a string without escapes, are compiled to a
+ * WBindingAction. Anything else is left to Lua.
+ */
+
+#define NAME_LEN 64
+
+
+static const char *skip_space(const char *p)
+{
+    while(*p==' ' || *p=='\t')
+        p++;
+    return p;
+}
+
+
+static bool get_name(const char **pp, char *buf)
+{
+    const char *p=*pp;
+    int n=0;
+
+    if(!isalpha((uchar)*p) && *p!='_')
+        return FALSE;
+
+    while(isalnum((uchar)*p) || *p=='_'){
+        if(n==NAME_LEN-1)
+            return FALSE;
+        buf[n++]=*p++;
+    }
+
+    buf[n]='\0';
+    *pp=p;
+
+    return TRUE;
+}
+
+
+/* Parses one argument, setting 'kind' to one of "onbids" for objects,
+ * nil, booleans, integers, other numbers and strings.
+ */
+static bool get_arg(const char **pp, WBindingAction *action, int i,
+                    char *kind)
+{
+    char name[NAME_LEN];
+    const char *p=*pp, *end;
+    char *e;
+
+    action->src[i]=BINDING_ARG_CONST;
+
+    if(*p=='"' || *p=='\''){
+        end=strchr(p+1, *p);
+        if(end==NULL || memchr(p+1, '\\', end-p-1)!=NULL)
+            return FALSE;
+        action->args[i].s=scopyn(p+1, end-p-1);
+        if(action->args[i].s==NULL)
+            return FALSE;
+        action->src[i]=BINDING_ARG_STR;
+        *kind='s';
+        *pp=end+1;
+        return TRUE;
+    }
+
+    if(isdigit((uchar)*p) || *p=='-'){
+        action->args[i].d=strtod(p, &e);
+        if(e==p)
+            return FALSE;
+        *kind='d';
+        if(strspn(p+(*p=='-'), "0123456789")==(size_t)(e-p-(*p=='-'))){
+            action->args[i].i=(int)strtol(p, NULL, 10);
+            *kind='i';
+        }
+        *pp=e;
+        return TRUE;
+    }
+
+    if(!get_name(&p, name))
+        return FALSE;
+
+    *pp=p;
+    *kind='o';
+
+    if(strcmp(name, "_")==0){
+        action->src[i]=BINDING_ARG_REG;
+    }else if(strcmp(name, "_sub")==0){
+        action->src[i]=BINDING_ARG_SUB;
+    }else if(strcmp(name, "_chld")==0){
+        action->src[i]=BINDING_ARG_CHLD;
+    }else if(strcmp(name, "nil")==0){
+        action->args[i].o=NULL;
+        *kind='n';
+    }else if(strcmp(name, "true")==0 || strcmp(name, "false")==0){
+        action->args[i].b=(name[0]=='t');
+        *kind='b';
+    }else{
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+static bool kind_ok(char kind, char type)
+{
+    switch(type){
+    case 'o':
+        return (kind=='o' || kind=='n');
+    case 'd':
+        return (kind=='d' || kind=='i');
+    case 'S':
+        return (kind=='s');
+    default:
+        return (kind==type);
+    }
+}
+
+
+static bool get_guard(WBindingAction *action, const char *guard)
+{
+    const char *cls;
+
+    if(strncmp(guard, "_sub:", 5)==0){
+        action->guard_src=BINDING_ARG_SUB;
+        cls=guard+5;
+    }else if(strncmp(guard, "_chld:", 6)==0){
+        action->guard_src=BINDING_ARG_CHLD;
+        cls=guard+6;
+    }else{
+        return FALSE;
+    }
+
+    if(*cls=='\0' || cls[strspn(cls, "abcdefghijklmnopqrstuvwxyz"
+                                     "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                     "0123456789-_")]!='\0'){
+        return FALSE;
+    }
+
+    if(strcmp(cls, "non-nil")!=0){
+        action->guard_cls=scopy(cls);
+        if(action->guard_cls==NULL)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+static WBindingAction *compile_action(ExtlTab tab)
+{
+    char mod[NAME_LEN], name[NAME_LEN], kinds[BINDING_ACTION_MAX_ARGS];
+    char *cmd=NULL, *guard=NULL;
+    WBindingAction *action=NULL;
+    const char *p, *ispec;
+    bool has_mod=FALSE;
+    int i;
+
+    if(!extl_table_gets_s(tab, "cmdstr", &cmd))
+        return NULL;
+
+    action=ALLOC(WBindingAction);
+    if(action==NULL)
+        goto fail;
+
+    action->guard_src=BINDING_ARG_NONE;
+
+    if(extl_table_gets_s(tab, "guard", &guard) && !get_guard(action, guard))
+        goto fail;
+
+    p=skip_space(cmd);
+
+    if(!get_name(&p, name))
+        goto fail;
+
+    if(*p=='.'){
+        strcpy(mod, name);
+        has_mod=TRUE;
+        p++;
+        if(!get_name(&p, name))
+            goto fail;
+    }
+
+    p=skip_space(p);
+    if(*p++!='(')
+        goto fail;
+
+    p=skip_space(p);
+
+    while(*p!=')'){
+        if(action->nargs==BINDING_ACTION_MAX_ARGS)
+            goto fail;
+        i=action->nargs++;
+        if(!get_arg(&p, action, i, &kinds[i]))
+            goto fail;
+        p=skip_space(p);
+        if(*p==',')
+            p=skip_space(p+1);
+        else if(*p!=')')
+            goto fail;
+    }
+
+    if(*skip_space(p+1)!='\0')
+        goto fail;
+
+    if(!extl_lookup_direct(has_mod ? mod : NULL, name, &action->fn))
+        goto fail;
+
+    ispec=action->fn.spec->ispec;
+
+    if((int)(ispec==NULL ? 0 : strlen(ispec))!=action->nargs)
+        goto fail;
+
+    for(i=0; i<action->nargs; i++){
+        if(!kind_ok(kinds[i], ispec[i]))
+            goto fail;
+        if(kinds[i]=='i' && ispec[i]=='d')
+            action->args[i].d=action->args[i].i;
+    }
+
+    free(cmd);
+    if(guard!=NULL)
+        free(guard);
+
+    return action;
+
+fail:
+    if(action!=NULL)
+        binding_action_destroy(action);
+    free(cmd);
+    if(guard!=NULL)
+        free(guard);
+
+    return NULL;
+}
+
+
+/*}}}*/
+
+
 /*{{{ bindmap_defbindings */
 
 static bool do_action(WBindmap *bindmap, const char *str,
-                      ExtlFn func, uint act, uint mod, uint ksb,
-                      int area, bool wr,
+                      ExtlFn func, WBindingAction *action,
+                      uint act, uint mod, uint ksb, int area, bool wr,
                       const char* doc, const char* label)
 {
     WBinding binding;
@@ -182,12 +424,14 @@ static bool do_action(WBindmap *bindmap, const char *str,
 
     if(func!=extl_fn_none()){
         binding.func=extl_ref_fn(func);
+        binding.action=action;
         if(bindmap_add_binding(bindmap, &binding))
             return TRUE;
         extl_unref_fn(binding.func);
         warn(TR("Unable to add binding %s."), str);
     }else{
         binding.func=func;
+        binding.action=NULL;
         if(bindmap_remove_binding(bindmap, &binding))
             return TRUE;
         warn(TR("Unable to remove binding %s."), str);
@@ -216,6 +460,7 @@ static bool do_submap(WBindmap *bindmap, const char *str,
     binding.kcb=kcb;
     binding.area=0;
     binding.func=extl_fn_none();
+    binding.action=NULL;
     binding.submap=create_bindmap();
     binding.doc=NULL;
     binding.label=NULL;
@@ -254,6 +499,7 @@ static bool do_entry(WBindmap *bindmap, ExtlTab tab,
     int action=0;
     uint ksb=0, mod=0;
     ExtlFn func;
+    WBindingAction *baction=NULL;
     bool wr=FALSE;
     int area=0;
 
@@ -306,10 +552,16 @@ static bool do_entry(WBindmap *bindmap, ExtlTab tab,
 
         if(!extl_table_gets_f(tab, "func", &func)){
             func=extl_fn_none();
+        }else if(action==BINDING_KEYPRESS){
+            baction=compile_action(tab);
         }
-        ret=do_action(bindmap, ksb_str, func, action, mod, ksb, area, wr, *doc, *label);
-        if(!ret)
+        ret=do_action(bindmap, ksb_str, func, baction, action, mod, ksb,
+                      area, wr, *doc, *label);
+        if(!ret){
             extl_unref_fn(func);
+            if(baction!=NULL)
+                binding_action_destroy(baction);
+        }
     }
 fail:
     if(action_str!=NULL)
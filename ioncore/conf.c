@@ -24,6 +24,7 @@
 #include "reginfo.h"
 #include "group-ws.h"
 #include "llist.h"
+#include "winprops.h"
 
 
 StringIntMap frame_idxs[]={
@@ -241,11 +242,12 @@ ExtlTab ioncore_get_winprop(WClientWin *cwin)
 {
     ExtlTab tab=extl_table_none();
 
-    if(get_winprop_fn_set){
-        extl_protect(NULL);
+    extl_protect(NULL);
+    if(get_winprop_fn_set)
         extl_call(get_winprop_fn, "o", "t", cwin, &tab);
-        extl_unprotect(NULL);
-    }
+    else
+        tab=ioncore_getwinprop(cwin);
+    extl_unprotect(NULL);
 
     return tab;
 }
@@ -253,13 +253,13 @@ void ioncore_handle_property(const XPropertyEvent *ev)
     }
 
     /* Call property hook */
-    {
+    if(!HOOK_IS_EMPTY(clientwin_property_change_hook)){
         void *p[2];
         p[0]=(void*)cwin;
         p[1]=(void*)ev;
-        hook_call(clientwin_property_change_hook, p,
-                  (WHookMarshall*)pchg_mrsh,
-                  (WHookMarshallExtl*)pchg_mrsh_extl);
+        hook_call_key(clientwin_property_change_hook, p, (void*)ev->atom,
+                      (WHookMarshall*)pchg_mrsh,
+                      (WHookMarshallExtl*)pchg_mrsh_extl);
     }
 }
 
@@ -80,26 +80,17 @@ bool extl_table_is_bool_set(ExtlTab tab, const char *entry)
 
 bool extl_table_to_rectangle(ExtlTab tab, WRectangle *rectret)
 {
-    if(!extl_table_gets_i(tab, "x", &(rectret->x)) ||
-       !extl_table_gets_i(tab, "y", &(rectret->y)) ||
-       !extl_table_gets_i(tab, "w", &(rectret->w)) ||
-       !extl_table_gets_i(tab, "h", &(rectret->h)))
-       return FALSE;
-
-    return TRUE;
+    return (extl_table_gets_many(tab, "iiii",
+                                 "x", &(rectret->x), "y", &(rectret->y),
+                                 "w", &(rectret->w), "h", &(rectret->h))
+            ==0xf);
 }
 
 
 ExtlTab extl_table_from_rectangle(const WRectangle *rect)
 {
-    ExtlTab tab=extl_create_table();
-
-    extl_table_sets_i(tab, "x", rect->x);
-    extl_table_sets_i(tab, "y", rect->y);
-    extl_table_sets_i(tab, "w", rect->w);
-    extl_table_sets_i(tab, "h", rect->h);
-
-    return tab;
+    return extl_create_table_with("iiii", "x", rect->x, "y", rect->y,
+                                  "w", rect->w, "h", rect->h);
 }
 
 
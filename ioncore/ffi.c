@@ -0,0 +1,67 @@
+/*
+ * notion/ioncore/ffi.c
+ *
+ * Copyright (c) 2026 The Notion development team
+ *
+ * See the included file LICENSE for details.
+ */
+
+#include "common.h"
+#include "region.h"
+#include "mplex.h"
+#include "names.h"
+#include "ffi.h"
+
+
+/* Plain C entry points for LuaJIT's FFI to some of the most often called
+ * read-only accessors; see ioncore_ffi.lua. The Lua side takes the object
+ * out of its proxy, so it may be NULL if dead or of any class. Such calls
+ * return FALSE or -1, and the Lua side then falls back to the exported
+ * function, which reports the error.
+ */
+
+
+bool ioncore_ffi_region_geom(Obj *obj, WRectangle *geom_ret)
+{
+    WRegion *reg=OBJ_CAST(obj, WRegion);
+
+    if(reg==NULL)
+        return FALSE;
+
+    *geom_ret=REGION_GEOM(reg);
+    return TRUE;
+}
+
+
+bool ioncore_ffi_region_name(Obj *obj, const char **name_ret)
+{
+    WRegion *reg=OBJ_CAST(obj, WRegion);
+
+    if(reg==NULL)
+        return FALSE;
+
+    *name_ret=region_name(reg);
+    return TRUE;
+}
+
+
+int ioncore_ffi_region_is_active(Obj *obj)
+{
+    WRegion *reg=OBJ_CAST(obj, WRegion);
+
+    if(reg==NULL)
+        return -1;
+
+    return (REGION_IS_ACTIVE(reg) ? 1 : 0);
+}
+
+
+int ioncore_ffi_mplex_mx_count(Obj *obj)
+{
+    WMPlex *mplex=OBJ_CAST(obj, WMPlex);
+
+    if(mplex==NULL)
+        return -1;
+
+    return mplex_mx_count(mplex);
+}
@@ -0,0 +1,20 @@
+/*
+ * notion/ioncore/ffi.h
+ *
+ * Copyright (c) 2026 The Notion development team
+ *
+ * See the included file LICENSE for details.
+ */
+
+#ifndef NOTION_IONCORE_FFI_H
+#define NOTION_IONCORE_FFI_H
+
+#include <libtu/obj.h>
+#include "rectangle.h"
+
+extern bool ioncore_ffi_region_geom(Obj *obj, WRectangle *geom_ret);
+extern bool ioncore_ffi_region_name(Obj *obj, const char **name_ret);
+extern int ioncore_ffi_region_is_active(Obj *obj);
+extern int ioncore_ffi_mplex_mx_count(Obj *obj);
+
+#endif /* NOTION_IONCORE_FFI_H */
@@ -224,6 +224,94 @@ static void free_title(WFrame *frame, int i)
 }
 
 
+/*{{{ Title cache */
+
+
+/* Forget cached title widths and labels, e.g. when the brush changes. */
+void frame_flush_title_cache(WFrame *frame)
+{
+    int i;
+
+    if(frame->title_cache==NULL)
+        return;
+
+    for(i=0; i<frame->titles_n; i++){
+        WFrameTitleCache *c=&frame->title_cache[i];
+        if(c->name!=NULL){
+            free(c->name);
+            c->name=NULL;
+        }
+        c->label_iw=-1;
+    }
+}
+
+
+/* Text width of the display name of the i:th tab 'sub'. The width is
+ * only measured again if the name has changed, and in that case the
+ * label of the tab is also invalidated.
+ */
+int frame_title_text_width(WFrame *frame, int i, WRegion *sub)
+{
+    const char *name=region_displayname(sub);
+    WFrameTitleCache *c;
+
+    if(frame->title_cache==NULL || i>=frame->titles_n){
+        return (name==NULL ? 0 : grbrush_get_text_width(frame->bar_brush,
+                                                        name, strlen(name)));
+    }
+
+    c=&frame->title_cache[i];
+
+    if(name==NULL){
+        if(c->name!=NULL){
+            free(c->name);
+            c->name=NULL;
+            c->label_iw=-1;
+        }
+        return 0;
+    }
+
+    if(c->name==NULL || strcmp(c->name, name)!=0){
+        if(c->name!=NULL)
+            free(c->name);
+        c->name=scopy(name);
+        c->name_w=grbrush_get_text_width(frame->bar_brush, name, strlen(name));
+        c->label_iw=-1;
+    }
+
+    return c->name_w;
+}
+
+
+static bool title_label_valid(WFrame *frame, int i, WRegion *sub,
+                              int iw, int num)
+{
+    WFrameTitleCache *c;
+
+    if(frame->title_cache==NULL)
+        return FALSE;
+
+    /* Refreshes the cached name and invalidates the label on change */
+    frame_title_text_width(frame, i, sub);
+
+    c=&frame->title_cache[i];
+
+    return (c->name!=NULL && c->label_iw==iw && c->label_num==num);
+}
+
+
+static void title_label_set(WFrame *frame, int i, int iw, int num)
+{
+    if(frame->title_cache!=NULL){
+        frame->title_cache[i].label_iw=iw;
+        frame->title_cache[i].label_num=num;
+    }
+}
+
+
+/*}}}*/
+
+
 /* Proportional tabs algorithm:
   * Sort tabs by text sizes.
   * From smallest to largest do:
@@ -369,12 +457,13 @@ fprintf(stderr,"ZERR\n");
 
 void frame_recalc_bar(WFrame *frame)
 {
-    int textw, i;
+    int textw, num, i;
     WLListIterTmp tmp;
     WRegion *sub;
     char *title;
     bool set_shape;
     bool complete = TRUE;
+    uint gen;
 
     if(frame->bar_brush==NULL || frame->titles==NULL)
         return;
@@ -388,6 +477,12 @@ void frame_recalc_bar(WFrame *frame)
             frame_clear_shape(frame);
     }
 
+    gen=ioncore_shortenrules_generation();
+    if(frame->title_label_gen!=gen){
+        frame_flush_title_cache(frame);
+        frame->title_label_gen=gen;
+    }
+
     i=0;
 
     if(FRAME_MCOUNT(frame)==0){
@@ -401,14 +496,22 @@ void frame_recalc_bar(WFrame *frame)
         return;
     }
 
+    /* Only tabs whose name, width or number changed are labelled again. */
     FRAME_MX_FOR_ALL(sub, frame, tmp){
-        free_title(frame, i);
         textw=frame->titles[i].iw;
+        num=(frame->flags&FRAME_SHOW_NUMBERS ? i+1 : 0);
+
+        if(title_label_valid(frame, i, sub, textw, num)){
+            i++;
+            continue;
+        }
+
+        free_title(frame, i);
         if(textw>0){
-            if(frame->flags&FRAME_SHOW_NUMBERS){
+            if(num>0){
                 char *s=NULL;
                 const char *name=region_displayname(sub);
-                libtu_asprintf(&s, "[%d] %s", i+1, name);
+                libtu_asprintf(&s, "[%d] %s", num, name);
                 if(s!=NULL){
                     title=grbrush_make_label(frame->bar_brush, s, textw);
                     free(s);
@@ -420,6 +523,7 @@ void frame_recalc_bar(WFrame *frame)
             }
             frame->titles[i].text=title;
         }
+        title_label_set(frame, i, textw, num);
         i++;
     }
 }
@@ -497,6 +601,8 @@ void frame_brushes_updated(WFrame *frame)
 
     frame->barmode=barmode;
 
+    frame_flush_title_cache(frame);
+
     if(barmode==FRAME_BAR_NONE || frame->bar_brush==NULL){
         frame->bar_h=0;
     }else{
@@ -581,6 +687,8 @@ void frame_initialise_gr(WFrame *frame)
 
 void frame_release_brushes(WFrame *frame)
 {
+    frame_flush_title_cache(frame);
+
     if(frame->bar_brush!=NULL){
         grbrush_release(frame->bar_brush);
         frame->bar_brush=NULL;
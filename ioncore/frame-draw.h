@@ -33,6 +33,8 @@ extern const char *framemode_get_style(WFrameMode mode);
 extern const char *framemode_get_tab_style(WFrameMode mode);
 
 extern void frame_update_attr(WFrame *frame, int i, WRegion *reg);
+extern int frame_title_text_width(WFrame *frame, int i, WRegion *sub);
+extern void frame_flush_title_cache(WFrame *frame);
 
 extern void frame_setup_dragwin_style(WFrame *frame, GrStyleSpec *spec, int tab);
 
@@ -32,18 +32,13 @@ static void get_titles_text_width(WFrame *frame)
     int i=0;
     WLListIterTmp itmp;
     WRegion *sub;
-    const char *displayname;
 
     /* Assume frame->bar_brush != NULL.
        Assume FRAME_MCOUNT(frame) > 0 */
 
+    /* Widths are cached per tab and only measured on name changes. */
     FRAME_MX_FOR_ALL(sub, frame, itmp){
-        displayname=region_displayname(sub);
-        if(displayname==NULL)
-            frame->titles[i].iw=0;
-        else
-            frame->titles[i].iw=grbrush_get_text_width(frame->bar_brush,
-                                            displayname, strlen(displayname));
+        frame->titles[i].iw=frame_title_text_width(frame, i, sub);
         i++;
     }
 }
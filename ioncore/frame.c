@@ -72,6 +72,7 @@ bool frame_init(WFrame *frame, WWindow *parent, const WFitParams *fp,
     frame->saved_geom.y=0;
     frame->tab_dragged_idx=-1;
     frame->titles=NULL;
+    frame->title_cache=NULL;
     frame->titles_n=0;
     frame->bar_h=0;
     frame->bar_w=fp->g.w;
@@ -162,6 +163,7 @@ void frame_set_mode(WFrame *frame, WFrameMode mode)
     region_remove_bindmap((WRegion*)frame, ioncore_frame_transient_bindmap);
 
     frame->mode=mode;
+    region_conf_changed((WRegion*)frame);
 
     frame_add_mode_bindmaps(frame);
 
@@ -300,19 +302,34 @@ static void frame_update_attrs(WFrame *frame)
 }
 
 
-static void frame_free_titles(WFrame *frame)
+static void free_titles(GrTextElem *titles, WFrameTitleCache *cache, int n)
 {
     int i;
 
-    if(frame->titles!=NULL){
-        for(i=0; i<frame->titles_n; i++){
-            if(frame->titles[i].text)
-                free(frame->titles[i].text);
-            gr_stylespec_unalloc(&frame->titles[i].attr);
+    if(titles!=NULL){
+        for(i=0; i<n; i++){
+            if(titles[i].text)
+                free(titles[i].text);
+            gr_stylespec_unalloc(&titles[i].attr);
         }
-        free(frame->titles);
-        frame->titles=NULL;
+        free(titles);
     }
+
+    if(cache!=NULL){
+        for(i=0; i<n; i++){
+            if(cache[i].name!=NULL)
+                free(cache[i].name);
+        }
+        free(cache);
+    }
+}
+
+
+static void frame_free_titles(WFrame *frame)
+{
+    free_titles(frame->titles, frame->title_cache, frame->titles_n);
+    frame->titles=NULL;
+    frame->title_cache=NULL;
     frame->titles_n=0;
 }
 
@@ -323,22 +340,62 @@ static void do_init_title(WFrame *frame, int i, WRegion *sub)
 
     gr_stylespec_init(&frame->titles[i].attr);
 
+    frame->title_cache[i].reg=sub;
+    frame->title_cache[i].name=NULL;
+    frame->title_cache[i].label_iw=-1;
+
     frame_update_attr(frame, i, sub);
 }
 
 
+/* Move the label and cached values of the tab for 'sub' over from the
+ * previous titles, so that tabs that did not change need not be
+ * measured and labelled again.
+ */
+static void reuse_title(WFrame *frame, int i, WRegion *sub,
+                        GrTextElem *old_titles, WFrameTitleCache *old_cache,
+                        int old_n)
+{
+    int j;
+
+    if(sub==NULL || old_cache==NULL)
+        return;
+
+    for(j=0; j<old_n; j++){
+        if(old_cache[j].reg==sub){
+            frame->titles[i].text=old_titles[j].text;
+            old_titles[j].text=NULL;
+            frame->title_cache[i]=old_cache[j];
+            old_cache[j].reg=NULL;
+            old_cache[j].name=NULL;
+            return;
+        }
+    }
+}
+
+
 static bool frame_initialise_titles(WFrame *frame)
 {
-    int i, n=FRAME_MCOUNT(frame);
+    GrTextElem *old_titles=frame->titles;
+    WFrameTitleCache *old_cache=frame->title_cache;
+    int i, old_n=frame->titles_n, n=FRAME_MCOUNT(frame);
 
-    frame_free_titles(frame);
+    frame->titles=NULL;
+    frame->title_cache=NULL;
+    frame->titles_n=0;
 
     if(n==0)
         n=1;
 
     frame->titles=ALLOC_N(GrTextElem, n);
-    if(frame->titles==NULL)
+    frame->title_cache=ALLOC_N(WFrameTitleCache, n);
+    if(frame->titles==NULL || frame->title_cache==NULL){
+        free_titles(frame->titles, frame->title_cache, 0);
+        frame->titles=NULL;
+        frame->title_cache=NULL;
+        free_titles(old_titles, old_cache, old_n);
         return FALSE;
+    }
     frame->titles_n=n;
 
     if(FRAME_MCOUNT(frame)==0){
@@ -349,10 +406,13 @@ static bool frame_initialise_titles(WFrame *frame)
         i=0;
         FRAME_MX_FOR_ALL(sub, frame, tmp){
             do_init_title(frame, i, sub);
+            reuse_title(frame, i, sub, old_titles, old_cache, old_n);
             i++;
         }
     }
 
+    free_titles(old_titles, old_cache, old_n);
+
     frame_recalc_bar(frame);
 
     return TRUE;
@@ -975,13 +1035,15 @@ ExtlTab frame_get_configuration(WFrame *frame)
     extl_table_sets_i(tab, "mode", frame->mode);
 
     if(frame->flags&FRAME_SAVED_VERT){
-        extl_table_sets_i(tab, "saved_y", frame->saved_geom.y);
-        extl_table_sets_i(tab, "saved_h", frame->saved_geom.h);
+        extl_table_sets_many(tab, "ii",
+                             "saved_y", frame->saved_geom.y,
+                             "saved_h", frame->saved_geom.h);
     }
 
     if(frame->flags&FRAME_SAVED_HORIZ){
-        extl_table_sets_i(tab, "saved_x", frame->saved_geom.x);
-        extl_table_sets_i(tab, "saved_w", frame->saved_geom.w);
+        extl_table_sets_many(tab, "ii",
+                             "saved_x", frame->saved_geom.x,
+                             "saved_w", frame->saved_geom.w);
     }
 
     return tab;
@@ -54,6 +54,16 @@ typedef enum{
 
 
 
+/* Per-tab values cached across frame_recalc_bar calls; see frame-draw.c */
+typedef struct{
+    WRegion *reg;       /* Identity only, used to keep entries on reorder */
+    char *name;         /* Display name the entry is valid for */
+    int name_w;         /* Text width of name with the bar brush */
+    int label_iw;       /* Width the label in titles[] was made for */
+    int label_num;      /* Tab number in the label, or 0 */
+} WFrameTitleCache;
+
+
 DECLCLASS(WFrame){
     WMPlex mplex;
 
@@ -69,6 +79,8 @@ DECLCLASS(WFrame){
     GrStyleSpec baseattr;
     GrTransparency tr_mode;
     GrTextElem *titles;
+    WFrameTitleCache *title_cache;
+    uint title_label_gen;
     int titles_n;
 
     /* Bar stuff */
@@ -142,12 +142,120 @@ GrBrush *gr_get_brush(Window win, WRootWin *rootwin, const char *style)
 /*}}}*/
 
 
-/*{{{ Scoring */
+/*{{{ Attribute registry */
+
+
+/* Attributes are given dense ids on first use in a style specification,
+ * so that specifications can carry a bitset of their attributes.
+ * Registered attributes are referenced for good to keep the ids stable;
+ * attributes that do not fit in the bitset are simply not registered and
+ * mark the specifications that contain them inexact.
+ */
+
+#define GR_ATTR_WORDBITS (sizeof(uint)*8)
+#define GR_ATTR_NBITS (GR_STYLESPEC_WORDS*GR_ATTR_WORDBITS)
+#define GR_ATTR_HASHSIZE (2*GR_ATTR_NBITS)
 
+static GrAttr attr_hash[GR_ATTR_HASHSIZE];
+static uint attr_hash_id[GR_ATTR_HASHSIZE];
+static uint n_attr_ids=0;
 
 static GrAttr star_id=STRINGID_NONE;
 
 
+static GrAttr get_star_id()
+{
+    if(star_id==STRINGID_NONE)
+        star_id=stringstore_alloc("*");
+    return star_id;
+}
+
+
+static uint attr_hash_slot(GrAttr a)
+{
+    ulong h=(ulong)a>>3;
+    uint i=(uint)((h^(h>>9))%GR_ATTR_HASHSIZE);
+
+    /* The table is never more than half full. */
+    while(attr_hash[i]!=GRATTR_NONE && attr_hash[i]!=a)
+        i=(i+1)%GR_ATTR_HASHSIZE;
+
+    return i;
+}
+
+
+/* Returns the dense id of 'a' or -1 if it has none. */
+static int attr_find_id(GrAttr a)
+{
+    uint i=attr_hash_slot(a);
+
+    return (attr_hash[i]==a ? (int)attr_hash_id[i] : -1);
+}
+
+
+static int attr_get_id(GrAttr a)
+{
+    uint i=attr_hash_slot(a);
+
+    if(attr_hash[i]==a)
+        return attr_hash_id[i];
+
+    if(n_attr_ids>=GR_ATTR_NBITS)
+        return -1;
+
+    stringstore_ref(a);
+    attr_hash[i]=a;
+    attr_hash_id[i]=n_attr_ids;
+
+    return n_attr_ids++;
+}
+
+
+static void stylespec_note_attr(GrStyleSpec *spec, const GrAttrScore *as)
+{
+    int id;
+
+    if(as->score!=1)
+        spec->flags|=GR_STYLESPEC_WEIGHTED;
+
+    if(as->attr==get_star_id()){
+        spec->flags|=GR_STYLESPEC_STAR;
+        return;
+    }
+
+    id=attr_get_id(as->attr);
+
+    if(id<0)
+        spec->flags|=GR_STYLESPEC_INEXACT;
+    else
+        spec->bits[id/GR_ATTR_WORDBITS]|=1u<<(id%GR_ATTR_WORDBITS);
+}
+
+
+static void stylespec_clear_bits(GrStyleSpec *spec)
+{
+    memset(spec->bits, 0, sizeof(spec->bits));
+    spec->flags=0;
+}
+
+
+static void stylespec_update_bits(GrStyleSpec *spec)
+{
+    uint i;
+
+    stylespec_clear_bits(spec);
+
+    for(i=0; i<spec->n; i++)
+        stylespec_note_attr(spec, &spec->attrs[i]);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Scoring */
+
+
 static int cmp(const void *a_, const void *b_)
 {
     StringId a=*(const StringId*)a_;
@@ -164,10 +272,7 @@ static uint scorefind(const GrStyleSpec *attr, const GrAttrScore *spec)
     if(attr->attrs==NULL)
         return 0;
 
-    if(star_id==STRINGID_NONE)
-        star_id=stringstore_alloc("*");
-
-    if(spec->attr==star_id){
+    if(spec->attr==get_star_id()){
         /* Since every item occurs only once on the list, with a score,
          * return the score of the star in the spec, instead of one.
          */
@@ -183,9 +288,27 @@ static uint scorefind(const GrStyleSpec *attr, const GrAttrScore *spec)
 uint gr_stylespec_score2(const GrStyleSpec *spec, const GrStyleSpec *attr1,
                          const GrStyleSpec *attr2)
 {
+    uint aflags=attr1->flags|(attr2!=NULL ? attr2->flags : 0);
     uint score=0;
     uint i;
 
+    if(!((spec->flags|aflags)&GR_STYLESPEC_INEXACT)){
+        /* Every non-star attribute of spec must be found in attr1 or
+         * attr2 for a non-zero score.
+         */
+        for(i=0; i<GR_STYLESPEC_WORDS; i++){
+            uint a=attr1->bits[i]|(attr2!=NULL ? attr2->bits[i] : 0);
+            if(spec->bits[i]&~a)
+                return 0;
+        }
+
+        /* All found with unit score, and no stars: each counts two. */
+        if(!(spec->flags&GR_STYLESPEC_STAR) &&
+           !(aflags&GR_STYLESPEC_WEIGHTED)){
+            return 2*spec->n;
+        }
+    }
+
     for(i=0; i<spec->n; i++){
         uint sc=scorefind(attr1, &spec->attrs[i]);
 
@@ -286,6 +409,7 @@ void gr_stylespec_unalloc(GrStyleSpec *spec)
     }
 
     spec->n=0;
+    stylespec_clear_bits(spec);
 }
 
 
@@ -293,6 +417,7 @@ void gr_stylespec_init(GrStyleSpec *spec)
 {
     spec->attrs=NULL;
     spec->n=0;
+    stylespec_clear_bits(spec);
 }
 
 
@@ -315,7 +440,14 @@ static bool gr_stylespec_find_(const GrStyleSpec *spec, GrAttr a, int *idx_ge)
 
 bool gr_stylespec_isset(const GrStyleSpec *spec, GrAttr a)
 {
-    int idx_ge;
+    int idx_ge, id;
+
+    /* Stars and unregistered attributes are not in the bitset. */
+    if(a!=GRATTR_NONE){
+        id=attr_find_id(a);
+        if(id>=0)
+            return (spec->bits[id/GR_ATTR_WORDBITS]>>(id%GR_ATTR_WORDBITS))&1;
+    }
 
     return gr_stylespec_find_(spec, a, &idx_ge);
 }
@@ -332,6 +464,7 @@ bool gr_stylespec_add(GrStyleSpec *spec, GrAttr a, uint score)
 
     if(gr_stylespec_find_(spec, a, &idx_ge)){
         spec->attrs[idx_ge].score+=score;
+        spec->flags|=GR_STYLESPEC_WEIGHTED;
         return TRUE;
     }
 
@@ -349,6 +482,8 @@ bool gr_stylespec_add(GrStyleSpec *spec, GrAttr a, uint score)
     spec->attrs=idsn;
     spec->n++;
 
+    stylespec_note_attr(spec, &idsn[idx_ge]);
+
     return TRUE;
 }
 
@@ -382,6 +517,8 @@ void gr_stylespec_unset(GrStyleSpec *spec, GrAttr a)
 
     if(idsn!=NULL || spec->n==0)
         spec->attrs=idsn;
+
+    stylespec_update_bits(spec);
 }
 
 
@@ -403,6 +540,8 @@ static bool gr_stylespec_do_init_from(GrStyleSpec *dst, const GrStyleSpec *src)
     }
 
     dst->n=src->n;
+    memcpy(dst->bits, src->bits, sizeof(dst->bits));
+    dst->flags=src->flags;
 
     return TRUE;
 }
@@ -442,6 +581,35 @@ bool gr_stylespec_equals(const GrStyleSpec *s1, const GrStyleSpec *s2)
 }
 
 
+bool gr_stylespec_equals_scored(const GrStyleSpec *s1, const GrStyleSpec *s2)
+{
+    uint i;
+
+    if(s1->n!=s2->n)
+        return FALSE;
+
+    for(i=0; i<s1->n; i++){
+        if(s1->attrs[i].attr!=s2->attrs[i].attr ||
+           s1->attrs[i].score!=s2->attrs[i].score){
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+
+ulong gr_stylespec_hash(const GrStyleSpec *spec, ulong h)
+{
+    uint i;
+
+    for(i=0; i<spec->n; i++)
+        h=h*31+((ulong)spec->attrs[i].attr>>3)+spec->attrs[i].score;
+
+    return h;
+}
+
+
 /*}}}*/
 
 
@@ -45,7 +45,15 @@ typedef StringId GrAttr;
 
 #define GRATTR_NONE STRINGID_NONE
 
-#define GR_STYLESPEC_INIT {0, NULL}
+/* Number of words in the attribute bitset of a GrStyleSpec, see gr.c. */
+#define GR_STYLESPEC_WORDS 8
+
+/* GrStyleSpec.flags */
+#define GR_STYLESPEC_INEXACT  0x0001 /* Attributes missing from bits */
+#define GR_STYLESPEC_WEIGHTED 0x0002 /* Some score is not one */
+#define GR_STYLESPEC_STAR     0x0004 /* Contains '*' */
+
+#define GR_STYLESPEC_INIT {0, NULL, {0, 0, 0, 0, 0, 0, 0, 0}, 0}
 
 typedef struct{
     GrAttr attr;
@@ -55,6 +63,9 @@ typedef struct{
 typedef struct{
     uint n;
     GrAttrScore *attrs;
+    /* Non-star attributes by dense attribute id; derived from attrs. */
+    uint bits[GR_STYLESPEC_WORDS];
+    uint flags;
 } GrStyleSpec;
 
 #define GR_TEXTELEM_INIT {NULL, 0, GR_STYLESPEC_INIT}
@@ -113,6 +124,13 @@ extern bool gr_stylespec_add(GrStyleSpec *spec, GrAttr a, uint score);
 extern bool gr_stylespec_append(GrStyleSpec *dst, const GrStyleSpec *src);
 extern void gr_stylespec_unalloc(GrStyleSpec *spec);
 extern bool gr_stylespec_equals(const GrStyleSpec *s1, const GrStyleSpec *s2);
+/* Like gr_stylespec_equals, but the scores must also agree. */
+extern bool gr_stylespec_equals_scored(const GrStyleSpec *s1,
+                                       const GrStyleSpec *s2);
+/* Combines the attributes and scores of 'spec' into the hash value 'h'.
+ * Specs that are gr_stylespec_equals_scored hash equally.
+ */
+extern ulong gr_stylespec_hash(const GrStyleSpec *spec, ulong h);
 extern bool gr_stylespec_load(GrStyleSpec *spec, const char *str);
 extern bool gr_stylespec_load_(GrStyleSpec *spec, const char *str,
                                bool no_order_score);
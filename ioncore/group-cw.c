@@ -154,6 +154,8 @@ void groupcw_toggle_transients_pos(WGroupCW *cwg)
             region_fitrep(st->reg, NULL, &fp);
         }
     }
+
+    region_conf_changed((WRegion*)cwg);
 }
 
 
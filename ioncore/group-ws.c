@@ -50,6 +50,7 @@ void ioncore_groupws_set(ExtlTab tab)
         else
             warn(TR("Unknown placement method \"%s\"."), method);
         free(method);
+        ioncore_conf_changed();
     }
 }
 
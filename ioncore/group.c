@@ -495,6 +495,7 @@ static void group_do_set_bottom(WGroup *grp, WStacking *st)
     grp->bottom=st;
 
     if(st!=was){
+        region_conf_changed((WRegion*)grp);
         if(st==NULL || HAS_DYN(st->reg, region_manage_stdisp))
             group_remanage_stdisp(grp);
 
@@ -776,18 +777,7 @@ static void get_params(WGroup *ws, ExtlTab tab, WGroupAttachParams *par)
     }
 
     if(extl_table_gets_t(tab, "geom", &g)){
-        int n=0;
-
-        if(extl_table_gets_i(g, "x", &(par->geom.x)))
-            n++;
-        if(extl_table_gets_i(g, "y", &(par->geom.y)))
-            n++;
-        if(extl_table_gets_i(g, "w", &(par->geom.w)))
-            n++;
-        if(extl_table_gets_i(g, "h", &(par->geom.h)))
-            n++;
-
-        if(n==4)
+        if(extl_table_to_rectangle(g, &(par->geom)))
             par->geom_set=1;
 
         extl_unref_table(g);
@@ -1274,16 +1264,15 @@ ExtlTab group_get_configuration(WGroup *ws)
         subtab=region_get_configuration(st->reg);
 
         if(subtab!=extl_table_none()){
-            extl_table_sets_s(subtab, "sizepolicy",
-                              sizepolicy2string(st->szplcy));
-            extl_table_sets_i(subtab, "level", st->level);
-
             tmpg=REGION_GEOM(st->reg);
             tmpg.x-=REGION_GEOM(ws).x;
             tmpg.y-=REGION_GEOM(ws).y;
 
             g=extl_table_from_rectangle(&tmpg);
-            extl_table_sets_t(subtab, "geom", g);
+            extl_table_sets_many(subtab, "sit",
+                                 "sizepolicy", sizepolicy2string(st->szplcy),
+                                 "level", st->level,
+                                 "geom", g);
             extl_unref_table(g);
 
             if(ws->bottom==st)
@@ -27,6 +27,7 @@
 
 #include <libtu/util.h>
 #include <libtu/optparser.h>
+#include <libtu/slab.h>
 #include <libextl/readconfig.h>
 #include <libextl/extl.h>
 #include <libmainloop/select.h>
@@ -62,6 +63,7 @@
 #include "screen-notify.h"
 #include "log.h"
 #include "tempdir.h"
+#include "winprops.h"
 
 #include "../version.h"
 #include "exports.h"
@@ -270,6 +272,53 @@ static bool init_messages(const char *localedir)
 
 #define INIT_HOOK(NM, DFLT) INIT_HOOK_(NM); ADD_HOOK_(NM, DFLT)
 
+/* Only the names region_notify_hook is called with are accepted, so
+ * that misspelt filters are reported.
+ */
+static void *notify_key(const char *name)
+{
+    const StringId known[]={
+        ioncore_g.notifies.activated,
+        ioncore_g.notifies.inactivated,
+        ioncore_g.notifies.activity,
+        ioncore_g.notifies.sub_activity,
+        ioncore_g.notifies.name,
+        ioncore_g.notifies.unset_manager,
+        ioncore_g.notifies.set_manager,
+        ioncore_g.notifies.tag,
+        ioncore_g.notifies.set_return,
+        ioncore_g.notifies.unset_return,
+        ioncore_g.notifies.pseudoactivated,
+        ioncore_g.notifies.pseudoinactivated,
+        ioncore_g.notifies.deinit,
+        ioncore_g.notifies.map,
+        ioncore_g.notifies.unmap
+    };
+    StringId id=stringstore_find(name);
+    uint i;
+
+    if(id==STRINGID_NONE)
+        return NULL;
+
+    for(i=0; i<sizeof(known)/sizeof(known[0]); i++){
+        if(known[i]==id){
+            stringstore_ref(id);
+            return (void*)id;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void *atom_key(const char *name)
+{
+    if(ioncore_g.dpy==NULL)
+        return NULL;
+    return (void*)XInternAtom(ioncore_g.dpy, name, False);
+}
+
+
 static bool init_hooks()
 {
     INIT_HOOK_(ioncore_post_layout_setup_hook);
@@ -280,11 +329,13 @@ static bool init_hooks()
     INIT_HOOK_(clientwin_mapped_hook);
     INIT_HOOK_(clientwin_unmapped_hook);
     INIT_HOOK_(clientwin_property_change_hook);
+    hook_set_keyfn(clientwin_property_change_hook, atom_key, NULL);
 
     INIT_HOOK_(region_notify_hook);
     ADD_HOOK_(region_notify_hook, ioncore_frame_quasiactivation_notify);
     ADD_HOOK_(region_notify_hook, ioncore_screen_activity_notify);
     ADD_HOOK_(region_notify_hook, ioncore_region_notify);
+    hook_set_keyfn(region_notify_hook, notify_key, stringstore_free);
 
     INIT_HOOK(clientwin_do_manage_alt, clientwin_do_manage_default);
     INIT_HOOK(ioncore_handle_event_alt, ioncore_handle_event);
@@ -659,6 +710,8 @@ void ioncore_deinit()
 
     ioncore_deinit_bindmaps();
 
+    ioncore_deinit_winprops();
+
     ioncore_deinit_xim();
 
     stringstore_deinit();
@@ -726,4 +779,38 @@ const char *ioncore_aboutmsg()
 }
 
 
+/*EXTL_DOC
+ * Returns statistics of the small object allocator as a list of
+ * tables with the fields \var{size} (object size of the class),
+ * \var{live} (objects in use), \var{peak} (most objects in use at
+ * any time), \var{slabs} and \var{bytes} (memory held by the class).
+ */
+EXTL_SAFE
+EXTL_EXPORT
+ExtlTab ioncore_slab_stats()
+{
+    ExtlTab t=extl_create_table();
+    SlabStats st;
+    int i, n=1;
+
+    for(i=0; i<slab_nclasses(); i++){
+        ExtlTab ct;
+
+        if(!slab_get_stats(i, &st) || (st.slabs==0 && st.peak==0))
+            continue;
+
+        ct=extl_create_table();
+        extl_table_sets_i(ct, "size", st.size);
+        extl_table_sets_i(ct, "live", st.live);
+        extl_table_sets_i(ct, "peak", st.peak);
+        extl_table_sets_i(ct, "slabs", st.slabs);
+        extl_table_sets_i(ct, "bytes", st.bytes);
+        extl_table_seti_t(t, n++, ct);
+        extl_unref_table(ct);
+    }
+
+    return t;
+}
+
+
 /*}}}*/
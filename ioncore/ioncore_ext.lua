@@ -20,6 +20,7 @@ ioncore.RESULT_DATA_LIMIT=1024^2
 
 -- Bindings, winprops, hooks, menu database and extra commands
 dopath('ioncore_luaext')
+dopath('ioncore_ffi')
 dopath('ioncore_bindings')
 dopath('ioncore_winprops')
 dopath('ioncore_misc')
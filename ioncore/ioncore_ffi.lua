@@ -0,0 +1,97 @@
+--
+-- notion/share/ioncore_ffi.lua
+--
+-- Copyright (c) 2026 The Notion development team
+--
+-- See the included file LICENSE for details.
+--
+
+-- When running on LuaJIT, replace some of the most often called read-only
+-- accessors by calls through the FFI, which the JIT compiler can inline
+-- into the calling trace. Elsewhere this file does nothing.
+
+local ok, ffi=pcall(require, "ffi")
+if not ok then
+    return
+end
+
+ffi.cdef[[
+typedef struct { void *obj; } ExtlFfiProxy;
+typedef struct { int x, y, w, h; } WRectangle;
+int ioncore_ffi_region_geom(void *obj, WRectangle *geom_ret);
+int ioncore_ffi_region_name(void *obj, const char **name_ret);
+int ioncore_ffi_region_is_active(void *obj);
+int ioncore_ffi_mplex_mx_count(void *obj);
+]]
+
+local C=ffi.C
+
+-- The entry points are only visible if the binary exports its symbols,
+-- which is not the case with preloaded modules.
+if not pcall(function() return C.ioncore_ffi_region_geom end) then
+    return
+end
+
+-- Object proxies are userdata starting with the object pointer, marked
+-- by metatable[MAGIC]==MAGIC (see libextl/luaextl.c).
+local MAGIC=0xf00ba7
+local proxy_t=ffi.typeof("ExtlFfiProxy*")
+
+local function objof(p)
+    if type(p)=="userdata" then
+        local mt=getmetatable(p)
+        if mt and rawget(mt, MAGIC)==MAGIC then
+            return ffi.cast(proxy_t, p).obj
+        end
+    end
+    return nil
+end
+
+local geom=ffi.new("WRectangle")
+local name=ffi.new("const char*[1]")
+
+local region_geom=WRegion.geom
+local region_name=WRegion.name
+local region_is_active=WRegion.is_active
+local mplex_mx_count=WMPlex.mx_count
+
+-- The exported functions are kept as fall-backs for dead objects and
+-- bad arguments so that those are reported as before.
+
+function WRegion.geom(reg)
+    local o=objof(reg)
+    if o~=nil and C.ioncore_ffi_region_geom(o, geom)~=0 then
+        return {x=geom.x, y=geom.y, w=geom.w, h=geom.h}
+    end
+    return region_geom(reg)
+end
+
+function WRegion.name(reg)
+    local o=objof(reg)
+    if o~=nil and C.ioncore_ffi_region_name(o, name)~=0 then
+        return (name[0]~=nil and ffi.string(name[0]) or nil)
+    end
+    return region_name(reg)
+end
+
+function WRegion.is_active(reg)
+    local o=objof(reg)
+    if o~=nil then
+        local a=C.ioncore_ffi_region_is_active(o)
+        if a>=0 then
+            return a==1
+        end
+    end
+    return region_is_active(reg)
+end
+
+function WMPlex.mx_count(mplex)
+    local o=objof(mplex)
+    if o~=nil then
+        local n=C.ioncore_ffi_mplex_mx_count(o)
+        if n>=0 then
+            return n
+        end
+    end
+    return mplex_mx_count(mplex)
+end
@@ -264,7 +264,12 @@ static bool do_key(WRegion *reg, XKeyEvent *ev)
             /* TODO: having to pass both mgd and subreg for some handlers
              * to work is ugly and complex.
              */
-            extl_call(binding->func, "ooo", NULL, binding_owner, mgd, subreg);
+            if(binding->action==NULL
+               || !binding_action_call(binding->action, binding_owner,
+                                       mgd, subreg)){
+                extl_call(binding->func, "ooo", NULL, binding_owner, mgd,
+                          subreg);
+            }
 
             current_kcb=0;
 
@@ -302,7 +302,7 @@ void mplex_set_index(WMPlex *mplex, WRegion *reg, int index)
     lnode=node->lnode;
 
     if(lnode==NULL){
-        lnode=ALLOC(WLListNode);
+        lnode=SLAB_ALLOC(WLListNode);
         if(lnode==NULL)
             return;
         lnode->next=NULL;
@@ -318,6 +318,7 @@ void mplex_set_index(WMPlex *mplex, WRegion *reg, int index)
 
     after=llist_index_to_after(mplex->mx_list, mplex->mx_current, index);
     llist_link_after(&(mplex->mx_list), after, lnode);
+    region_conf_changed((WRegion*)mplex);
     mplex_managed_changed(mplex, MPLEX_CHANGE_REORDER, FALSE, reg);
 }
 
@@ -889,6 +890,9 @@ bool mplex_set_hidden(WMPlex *mplex, WRegion *reg, int sp)
         mplex_do_node_display(mplex, node, TRUE);
     }
 
+    if(hidden!=nhidden)
+        region_conf_changed((WRegion*)mplex);
+
     if(mcf && !PASSIVE(node))
         mplex_refocus(mplex, (nhidden ? NULL : node), TRUE);
 
@@ -1147,7 +1151,7 @@ bool mplex_do_attach_final(WMPlex *mplex, WRegion *reg, WMPlexPHolder *ph)
         return FALSE;
 
     if(!(param->flags&MPLEX_ATTACH_UNNUMBERED)){
-        lnode=ALLOC(WLListNode);
+        lnode=SLAB_ALLOC(WLListNode);
         if(lnode==NULL){
             stacking_free(node);
             return FALSE;
@@ -1162,7 +1166,7 @@ bool mplex_do_attach_final(WMPlex *mplex, WRegion *reg, WMPlexPHolder *ph)
     if(!stacking_assoc(node, reg)){
         if(lnode!=NULL){
             node->lnode=NULL;
-            free(lnode);
+            SLAB_FREE(WLListNode, lnode);
         }
         stacking_free(node);
         return FALSE;
@@ -1522,7 +1526,7 @@ void mplex_managed_remove(WMPlex *mplex, WRegion *sub)
         llist_unlink(&(mplex->mx_list), node->lnode);
         mplex->mx_count--;
 
-        free(node->lnode);
+        SLAB_FREE(WLListNode, node->lnode);
         node->lnode=NULL;
         mx=TRUE;
     }
@@ -1864,14 +1868,13 @@ static const char *mode2str(int mode)
 
 static bool mrsh_chg(ExtlFn fn, WMPlexChangedParams *p)
 {
-    ExtlTab t=extl_create_table();
+    ExtlTab t=extl_create_table_with("osbo",
+                                     "reg", (Obj*)p->reg,
+                                     "mode", mode2str(p->mode),
+                                     "sw", p->sw,
+                                     "sub", (Obj*)p->sub);
     bool ret;
 
-    extl_table_sets_o(t, "reg", (Obj*)p->reg);
-    extl_table_sets_s(t, "mode", mode2str(p->mode));
-    extl_table_sets_b(t, "sw", p->sw);
-    extl_table_sets_o(t, "sub", (Obj*)p->sub);
-
     extl_protect(NULL);
     ret=extl_call(fn, "t", NULL, t);
     extl_unprotect(NULL);
@@ -1912,11 +1915,11 @@ static void save_node(WMPlex *mplex, ExtlTab subs, int *n,
     if(st!=extl_table_none()){
         if(mplex->mx_current!=NULL && node==mplex->mx_current->st)
             extl_table_sets_b(st, "switchto", TRUE);
-        extl_table_sets_s(st, "sizepolicy",
-                          sizepolicy2string(node->szplcy));
-        extl_table_sets_i(st, "level", node->level);
         g=extl_table_from_rectangle(&REGION_GEOM(node->reg));
-        extl_table_sets_t(st, "geom", g);
+        extl_table_sets_many(st, "sit",
+                             "sizepolicy", sizepolicy2string(node->szplcy),
+                             "level", node->level,
+                             "geom", g);
         extl_unref_table(g);
         if(STACKING_IS_HIDDEN(node))
             extl_table_sets_b(st, "hidden", TRUE);
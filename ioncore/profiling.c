@@ -80,3 +80,38 @@ void ioncore_profiling_stop()
     extl_resethook();
 #endif
 }
+
+/*EXTL_DOC
+ * Start sampling the Lua call stack every \var{interval} instructions
+ * (1000 if not positive), discarding earlier samples. Unlike
+ * \fnref{ioncore.profiling_start}, this is always available and cheap
+ * enough to leave running.
+ */
+EXTL_SAFE
+EXTL_EXPORT
+bool ioncore_lua_profiler_start(int interval)
+{
+    return extl_profiler_start(interval);
+}
+
+/*EXTL_DOC
+ * Stop sampling the Lua call stack. The samples are kept until the
+ * next \fnref{ioncore.lua_profiler_start}.
+ */
+EXTL_SAFE
+EXTL_EXPORT
+void ioncore_lua_profiler_stop()
+{
+    extl_profiler_stop();
+}
+
+/*EXTL_DOC
+ * Write the Lua call stacks sampled so far to \var{file} as folded
+ * stacks with times in microseconds, as taken by flame graph tools.
+ */
+EXTL_SAFE
+EXTL_EXPORT
+bool ioncore_lua_profiler_dump(const char *file)
+{
+    return extl_profiler_dump(file);
+}
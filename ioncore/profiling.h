@@ -12,4 +12,8 @@
 void ioncore_profiling_start();
 void ioncore_profiling_stop();
 
+bool ioncore_lua_profiler_start(int interval);
+void ioncore_lua_profiler_stop();
+bool ioncore_lua_profiler_dump(const char *file);
+
 #endif /* NOTION_IONCORE_PROFILING_H */
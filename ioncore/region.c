@@ -11,6 +11,7 @@
 #include <X11/Xatom.h>
 
 #include <libtu/objp.h>
+#include <libtu/minmax.h>
 #include <libextl/extl.h>
 #include <libmainloop/defer.h>
 
@@ -71,6 +72,10 @@ void region_init(WRegion *reg, WWindow *par, const WFitParams *fp)
 
     reg->mgd_activity=FALSE;
 
+    reg->conf_gen=0;
+    reg->conf_cache_gen=0;
+    reg->conf_cache=extl_table_none();
+
     if(par!=NULL){
         reg->rootwin=((WRegion*)par)->rootwin;
         region_set_parent(reg, par);
@@ -127,6 +132,11 @@ void region_deinit(WRegion *reg)
         D(warn("Region to be focused next destroyed[2]."));
         ioncore_g.focus_next=NULL;
     }
+
+    if(reg->conf_cache!=extl_table_none()){
+        extl_unref_table(reg->conf_cache);
+        reg->conf_cache=extl_table_none();
+    }
 }
 
 
@@ -140,6 +150,7 @@ bool region_fitrep(WRegion *reg, WWindow *par, const WFitParams *fp)
 {
     bool ret=FALSE;
     CALL_DYN_RET(ret, bool, region_fitrep, reg, (reg, par, fp));
+    region_conf_changed(reg);
     return ret;
 }
 
@@ -906,15 +917,75 @@ static void region_notify_change_(WRegion *reg, WRegionNotify how)
 {
     MRSHP p;
 
+    if(how!=ioncore_g.notifies.activated &&
+       how!=ioncore_g.notifies.inactivated &&
+       how!=ioncore_g.notifies.pseudoactivated &&
+       how!=ioncore_g.notifies.pseudoinactivated &&
+       how!=ioncore_g.notifies.activity &&
+       how!=ioncore_g.notifies.sub_activity &&
+       how!=ioncore_g.notifies.set_return &&
+       how!=ioncore_g.notifies.unset_return){
+        region_conf_changed(reg);
+    }
+
+    if(HOOK_IS_EMPTY(region_notify_hook))
+        return;
+
     p.reg=reg;
     p.how=how;
 
+    if(!HOOK_HAS_EXTL(region_notify_hook)){
+        hook_call_key(region_notify_hook, &p, NULL, mrsh_notify_change, NULL);
+        return;
+    }
+
     extl_protect(NULL);
-    hook_call(region_notify_hook, &p, mrsh_notify_change, mrshe_notify_change),
+    hook_call_key(region_notify_hook, &p, (void*)how,
+                  mrsh_notify_change, mrshe_notify_change);
     extl_unprotect(NULL);
 }
 
 
+/*{{{ Configuration generations */
+
+
+/* Each change that may show in a saved layout takes a new generation
+ * from conf_generation. The region and all regions containing it are
+ * marked with it, so that a region whose generation has not grown
+ * since it was last saved can reuse the configuration it saved then.
+ * Changes that affect all regions raise conf_generation_min instead.
+ */
+
+static ulong conf_generation=0;
+static ulong conf_generation_min=0;
+
+
+void region_conf_changed(WRegion *reg)
+{
+    ulong gen=++conf_generation;
+
+    while(reg!=NULL){
+        reg->conf_gen=gen;
+        reg=(reg->manager!=NULL ? reg->manager : (WRegion*)reg->parent);
+    }
+}
+
+
+ulong region_conf_gen(WRegion *reg)
+{
+    return MAXOF(reg->conf_gen, conf_generation_min);
+}
+
+
+void ioncore_conf_changed()
+{
+    conf_generation_min=++conf_generation;
+}
+
+
+/*}}}*/
+
+
 void region_notify_change(WRegion *reg, WRegionNotify how)
 {
     WRegion *mgr=REGION_MANAGER(reg);
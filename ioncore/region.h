@@ -114,6 +114,13 @@ DECLCLASS(WRegion){
     WRegion *manager;
 
     int mgd_activity;
+
+    /* Generation of the last change to what region_get_configuration
+     * returns for this region or those it contains, and a copy of that
+     * for regions whose configuration is cached. */
+    ulong conf_gen;
+    ulong conf_cache_gen;
+    ExtlTab conf_cache;
 };
 
 
@@ -165,6 +172,10 @@ extern void region_updategr_default(WRegion *reg);
 extern void region_rootpos(WRegion *reg, int *xret, int *yret);
 extern void region_notify_change(WRegion *reg, WRegionNotify how);
 
+extern void region_conf_changed(WRegion *reg);
+extern ulong region_conf_gen(WRegion *reg);
+extern void ioncore_conf_changed();
+
 extern bool region_goto(WRegion *reg);
 extern bool region_goto_flags(WRegion *reg, int flags);
 
@@ -11,6 +11,7 @@
 #include <unistd.h>
 
 #include <libtu/objp.h>
+#include <libtu/minmax.h>
 #include <libextl/readconfig.h>
 #include <libextl/extl.h>
 
@@ -139,31 +140,48 @@ bool region_supports_save(WRegion *reg)
 
 ExtlTab region_get_base_configuration(WRegion *reg)
 {
-    const char *name;
-    ExtlTab tab;
+    const char *name=(OBJ_IS(reg, WClientWin) ? NULL : region_name(reg));
 
-    tab=extl_create_table();
+    return extl_create_table_with("ss", "type", OBJ_TYPESTR(reg),
+                                  "name", name);
+}
 
-    extl_table_sets_s(tab, "type", OBJ_TYPESTR(reg));
 
-    name=region_name(reg);
+static bool get_config_clientwins=TRUE;
 
-    if(name!=NULL && !OBJ_IS(reg, WClientWin))
-        extl_table_sets_s(tab, "name", name);
 
-    return tab;
+/* The configurations of screens and workspaces are kept until the
+ * regions change (see region_conf_changed), so that saving the layout
+ * only walks the parts that did. Managers add their own entries to the
+ * tables of their children, so a copy of the cached table is returned.
+ */
+static bool conf_cached(WRegion *reg)
+{
+    return (get_config_clientwins &&
+            (OBJ_IS(reg, WGroupWS) || OBJ_IS(reg, WScreen)));
 }
 
 
-static bool get_config_clientwins=TRUE;
-
-
 ExtlTab region_get_configuration(WRegion *reg)
 {
     ExtlTab tab=extl_table_none();
+
+    if(conf_cached(reg) && reg->conf_cache!=extl_table_none()){
+        if(reg->conf_cache_gen==region_conf_gen(reg))
+            return extl_table_copy(reg->conf_cache);
+        extl_unref_table(reg->conf_cache);
+        reg->conf_cache=extl_table_none();
+    }
+
     if(get_config_clientwins || !OBJ_IS(reg, WClientWin)){
         CALL_DYN_RET(tab, ExtlTab, region_get_configuration, reg, (reg));
     }
+
+    if(conf_cached(reg) && tab!=extl_table_none()){
+        reg->conf_cache=extl_table_copy(tab);
+        reg->conf_cache_gen=region_conf_gen(reg);
+    }
+
     return tab;
 }
 
@@ -268,11 +286,44 @@ bool ioncore_init_layout()
 }
 
 
+/* Generation of the layout last saved, and the number of screens in
+ * it. The file is not rewritten when neither has changed. */
+static ulong saved_gen=0;
+static int saved_nscr=-1;
+
+
+static ulong layout_gen(int *nscr)
+{
+    WScreen *scr;
+    ulong gen=0;
+
+    *nscr=0;
+
+    FOR_ALL_SCREENS(scr){
+        if(screen_id(scr)<0)
+            continue;
+        gen=MAXOF(gen, region_conf_gen((WRegion*)scr));
+        (*nscr)++;
+    }
+
+    return gen;
+}
+
+
 bool ioncore_save_layout()
 {
     WScreen *scr=NULL;
-    ExtlTab tab=extl_create_table();
+    ExtlTab tab;
     bool ret;
+    ulong gen;
+    int nscr;
+
+    gen=layout_gen(&nscr);
+
+    if(gen==saved_gen && nscr==saved_nscr)
+        return TRUE;
+
+    tab=extl_create_table();
 
     if(tab==extl_table_none())
         return FALSE;
@@ -299,8 +350,12 @@ bool ioncore_save_layout()
 
     extl_unref_table(tab);
 
-    if(!ret)
+    if(!ret){
         warn(TR("Unable to save layout."));
+    }else{
+        /* Saving may itself mark client windows changed. */
+        saved_gen=layout_gen(&saved_nscr);
+    }
 
     return ret;
 }
@@ -6,7 +6,8 @@
  * See the included file LICENSE for details.
  */
 
-#include <libtu/rb.h>
+#include <libtu/ptrmap.h>
+#include <libtu/slab.h>
 
 #include "common.h"
 #include "region.h"
@@ -20,7 +21,7 @@
 
 WStacking *create_stacking()
 {
-    WStacking *st=ALLOC(WStacking);
+    WStacking *st=SLAB_ALLOC(WStacking);
 
     if(st!=NULL){
         st->reg=NULL;
@@ -43,7 +44,7 @@ void stacking_free(WStacking *st)
            st->lnode==NULL &&
            st->reg==NULL);
 
-    free(st);
+    SLAB_FREE(WStacking, st);
 }
 
 
@@ -53,34 +54,22 @@ void stacking_free(WStacking *st)
 /*{{{ Lookup */
 
 
-static Rb_node stacking_of_reg=NULL;
+static PtrMap stacking_of_reg=PTRMAP_INIT;
 
 
 WStacking *ioncore_find_stacking(WRegion *reg)
 {
-    Rb_node node=NULL;
-    int found=0;
-
-    if(stacking_of_reg!=NULL)
-        node=rb_find_pkey_n(stacking_of_reg, reg, &found);
-
-    return (found ? (WStacking*)node->v.val : NULL);
+    return (WStacking*)ptrmap_get(&stacking_of_reg, reg);
 }
 
 
 void stacking_unassoc(WStacking *st)
 {
-    Rb_node node=NULL;
-    int found=0;
-
     if(st->reg==NULL)
         return;
 
-    if(stacking_of_reg!=NULL)
-        node=rb_find_pkey_n(stacking_of_reg, st->reg, &found);
-
-    if(node!=NULL)
-        rb_delete_node(node);
+    if(ptrmap_get(&stacking_of_reg, st->reg)==st)
+        ptrmap_remove(&stacking_of_reg, st->reg);
 
     st->reg=NULL;
 }
@@ -90,13 +79,7 @@ bool stacking_assoc(WStacking *st, WRegion *reg)
 {
     assert(st->reg==NULL);
 
-    if(stacking_of_reg==NULL){
-        stacking_of_reg=make_rb();
-        if(stacking_of_reg==NULL)
-            return FALSE;
-    }
-
-    if(rb_insertp(stacking_of_reg, reg, st)==NULL)
+    if(!ptrmap_set(&stacking_of_reg, reg, st))
         return FALSE;
 
     st->reg=reg;
@@ -274,6 +257,7 @@ static void stacking_do_weave(WStacking **stacking, WStacking **np,
         UNLINK_ITEM(*np, st, next, prev);
 
         region_restack(st->reg, other, mode);
+        region_conf_changed(REGION_MANAGER(st->reg));
 
         if(ab!=NULL){
             LINK_ITEM_BEFORE(*stacking, ab, st, next, prev);
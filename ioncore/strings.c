@@ -8,6 +8,8 @@
 
 #include <libtu/output.h>
 #include <libtu/misc.h>
+#include <libtu/utf8.h>
+#include <libtu/minmax.h>
 #include <string.h>
 #include <regex.h>
 #include "log.h"
@@ -80,16 +82,8 @@ int str_prevoff(const char *p, int pos)
     if(ioncore_g.enc_sb)
         return (pos>0 ? 1 : 0);
 
-    if(ioncore_g.enc_utf8){
-        int opos=pos;
-
-        while(pos>0){
-            pos--;
-            if((p[pos]&0xC0)!=0x80)
-                break;
-        }
-        return opos-pos;
-    }
+    if(ioncore_g.enc_utf8)
+        return utf8_prevoff(p, pos);
 
     assert(ioncore_g.use_mb);
     {
@@ -119,16 +113,8 @@ int str_nextoff(const char *p, int opos)
     if(ioncore_g.enc_sb)
         return (*(p+opos)=='\0' ? 0 : 1);
 
-    if(ioncore_g.enc_utf8){
-        int pos=opos;
-
-        while(p[pos]){
-            pos++;
-            if((p[pos]&0xC0)!=0x80)
-                break;
-        }
-        return pos-opos;
-    }
+    if(ioncore_g.enc_utf8)
+        return utf8_nextoff(p, opos);
 
     assert(ioncore_g.use_mb);
     {
@@ -146,21 +132,40 @@ int str_nextoff(const char *p, int opos)
 }
 
 
+/* Byte offset of the 'n':th character of 'p', or the end of the string
+ * if it is shorter.
+ */
+int str_offset(const char *p, int n)
+{
+    int off=0, l;
+
+    if(ioncore_g.enc_sb){
+        l=strlen(p);
+        return MINOF(n, l);
+    }
+
+    if(ioncore_g.enc_utf8)
+        return utf8_offset(p, strlen(p), n);
+
+    while(n>0){
+        l=str_nextoff(p, off);
+        if(l==0)
+            break;
+        off+=l;
+        n--;
+    }
+
+    return off;
+}
+
+
 int str_len(const char *p)
 {
     if(ioncore_g.enc_sb)
         return strlen(p);
 
-    if(ioncore_g.enc_utf8){
-        int len=0;
-
-        while(*p){
-            if(((*p)&0xC0)!=0x80)
-                len++;
-            p++;
-        }
-        return len;
-    }
+    if(ioncore_g.enc_utf8)
+        return utf8_len(p, strlen(p));
 
     assert(ioncore_g.use_mb);
     {
@@ -200,6 +205,16 @@ DECLSTRUCT(SR){
 
 
 static SR *shortenrules=NULL;
+static uint shortenrules_gen=0;
+
+
+/* Changes whenever shortening rules are added, so that cached labels
+ * can be checked for validity.
+ */
+uint ioncore_shortenrules_generation()
+{
+    return shortenrules_gen;
+}
 
 
 /*EXTL_DOC
@@ -260,6 +275,7 @@ bool ioncore_defshortening(const char *rx, const char *rule, bool always)
         goto fail;
 
     LINK_ITEM(shortenrules, si, next, prev);
+    shortenrules_gen++;
 
     return TRUE;
 
@@ -23,11 +23,14 @@
 extern bool ioncore_defshortening(const char *rx, const char *rule,
                                   bool always);
 
+extern uint ioncore_shortenrules_generation();
+
 extern char *grbrush_make_label(GrBrush *brush, const char *str, uint maxw);
 
 extern int str_nextoff(const char *p, int pos);
 extern int str_prevoff(const char *p, int pos);
 extern int str_len(const char *p);
+extern int str_offset(const char *p, int n);
 extern wchar_t str_wchar_at(char *p, int max);
 extern char *str_stripws(char *p);
 
@@ -0,0 +1,377 @@
+/*
+ * notion/ioncore/winprops.c
+ *
+ * Copyright (c) 2026 The Notion development team
+ *
+ * See the included file LICENSE for details.
+ */
+
+#include <string.h>
+
+#include <libtu/dlist.h>
+#include <libtu/ptrmap.h>
+#include <libtu/stringstore.h>
+#include <libextl/extl.h>
+#include "common.h"
+#include "clientwin.h"
+#include "names.h"
+#include "extlconv.h"
+#include "winprops.h"
+
+
+/* Winprops are indexed by class, role and instance, each a stringstore
+ * id with "*" for any. Every level is a PtrMap keyed by the id, so a
+ * lookup is at most eight probes of interned strings. Each bucket lists
+ * its winprops newest first.
+ */
+
+
+INTRSTRUCT(WWinProp);
+
+DECLSTRUCT(WWinProp){
+    ExtlTab tab;
+    ExtlFn match;
+    bool has_match;
+    int is_transient;
+    int is_dockapp;
+    char *name;
+    bool name_plain;
+    bool oneshot;
+    WWinProp *next, *prev;
+};
+
+
+static PtrMap winprops=PTRMAP_INIT;
+static StringId wildcard=STRINGID_NONE;
+static ExtlFn string_find;
+static bool string_find_set=FALSE;
+
+
+/*{{{ Index */
+
+
+static PtrMap *get_level(PtrMap *map, StringId id, bool create)
+{
+    PtrMap *sub=(PtrMap*)ptrmap_get(map, id);
+
+    if(sub!=NULL || !create)
+        return sub;
+
+    sub=ALLOC(PtrMap);
+    if(sub==NULL)
+        return NULL;
+
+    if(!ptrmap_set(map, id, sub)){
+        free(sub);
+        return NULL;
+    }
+
+    stringstore_ref(id);
+
+    return sub;
+}
+
+
+static WWinProp **get_bucket(StringId c, StringId r, StringId i,
+                             bool create)
+{
+    PtrMap *roles, *instances;
+    WWinProp **bucket;
+
+    if(c==STRINGID_NONE || r==STRINGID_NONE || i==STRINGID_NONE)
+        return NULL;
+
+    roles=get_level(&winprops, c, create);
+    if(roles==NULL)
+        return NULL;
+
+    instances=get_level(roles, r, create);
+    if(instances==NULL)
+        return NULL;
+
+    bucket=(WWinProp**)ptrmap_get(instances, i);
+
+    if(bucket==NULL && create){
+        bucket=ALLOC(WWinProp*);
+        if(bucket==NULL)
+            return NULL;
+        if(!ptrmap_set(instances, i, bucket)){
+            free(bucket);
+            return NULL;
+        }
+        stringstore_ref(i);
+    }
+
+    return bucket;
+}
+
+
+static StringId find_id(const char *str)
+{
+    return (str==NULL ? STRINGID_NONE : stringstore_find(str));
+}
+
+
+/*}}}*/
+
+
+/*{{{ Winprops */
+
+
+static int get_tristate(ExtlTab tab, const char *entry)
+{
+    bool b=FALSE;
+
+    if(!extl_table_gets_b(tab, entry, &b))
+        return -1;
+
+    return b;
+}
+
+
+static bool is_plain(const char *pattern)
+{
+    return (strpbrk(pattern, "^$()%.[]*+-?")==NULL);
+}
+
+
+static WWinProp *create_winprop(ExtlTab tab)
+{
+    WWinProp *prop=ALLOC(WWinProp);
+
+    if(prop==NULL)
+        return NULL;
+
+    prop->tab=extl_ref_table(tab);
+    prop->has_match=extl_table_gets_f(tab, "match", &prop->match);
+    prop->is_transient=get_tristate(tab, "is_transient");
+    prop->is_dockapp=get_tristate(tab, "is_dockapp");
+    prop->name=NULL;
+    prop->name_plain=FALSE;
+    prop->oneshot=extl_table_is_bool_set(tab, "oneshot");
+
+    if(!prop->has_match && extl_table_gets_s(tab, "name", &prop->name))
+        prop->name_plain=is_plain(prop->name);
+
+    return prop;
+}
+
+
+static void free_winprop(WWinProp *prop)
+{
+    extl_unref_table(prop->tab);
+    if(prop->has_match)
+        extl_unref_fn(prop->match);
+    if(prop->name!=NULL)
+        free(prop->name);
+    free(prop);
+}
+
+
+static bool match_name(WWinProp *prop, WClientWin *cwin)
+{
+    const char *nm=region_name((WRegion*)cwin);
+    bool found=FALSE;
+
+    if(nm==NULL)
+        return FALSE;
+
+    if(prop->name_plain)
+        return (strstr(nm, prop->name)!=NULL);
+
+    if(!string_find_set){
+        string_find_set=extl_lookup_global_value(&string_find, 'f',
+                                                 "string", "find", NULL);
+        if(!string_find_set)
+            return FALSE;
+    }
+
+    extl_call(string_find, "ss", "b", nm, prop->name, &found);
+
+    return found;
+}
+
+
+static bool match_winprop(WWinProp *prop, WClientWin *cwin,
+                          const WClientWinIdent *id, ExtlTab *idtab)
+{
+    bool ret=FALSE;
+
+    if(prop->has_match){
+        if(*idtab==extl_table_none())
+            *idtab=clientwin_ident_table(id);
+        extl_call(prop->match, "tot", "b", prop->tab, cwin, *idtab, &ret);
+        return ret;
+    }
+
+    if(prop->is_transient>=0 && prop->is_transient!=id->is_transient)
+        return FALSE;
+
+    if(prop->is_dockapp>=0 && prop->is_dockapp!=id->is_dockapp)
+        return FALSE;
+
+    if(prop->name!=NULL)
+        return match_name(prop, cwin);
+
+    return TRUE;
+}
+
+
+/*}}}*/
+
+
+/*{{{ Exports */
+
+
+/*EXTL_DOC
+ * Add the winprop \var{tab} to the index. Use \fnref{ioncore.defwinprop}
+ * instead.
+ */
+EXTL_EXPORT
+void ioncore_do_defwinprop(ExtlTab tab)
+{
+    char *c=NULL, *r=NULL, *i=NULL;
+    StringId cid, rid, iid;
+    WWinProp **bucket=NULL;
+    WWinProp *prop;
+
+    if(wildcard==STRINGID_NONE)
+        wildcard=stringstore_alloc("*");
+
+    extl_table_gets_s(tab, "class", &c);
+    extl_table_gets_s(tab, "role", &r);
+    extl_table_gets_s(tab, "instance", &i);
+
+    cid=(c!=NULL ? stringstore_alloc(c) : wildcard);
+    rid=(r!=NULL ? stringstore_alloc(r) : wildcard);
+    iid=(i!=NULL ? stringstore_alloc(i) : wildcard);
+
+    bucket=get_bucket(cid, rid, iid, TRUE);
+
+    /* The index holds its own references to the ids. */
+    if(c!=NULL){
+        stringstore_free(cid);
+        free(c);
+    }
+    if(r!=NULL){
+        stringstore_free(rid);
+        free(r);
+    }
+    if(i!=NULL){
+        stringstore_free(iid);
+        free(i);
+    }
+
+    if(bucket==NULL){
+        warn_err();
+        return;
+    }
+
+    prop=create_winprop(tab);
+
+    if(prop==NULL)
+        return;
+
+    LINK_ITEM_FIRST(*bucket, prop, next, prev);
+}
+
+
+/*EXTL_DOC
+ * Find winprop table for \var{cwin}.
+ */
+EXTL_EXPORT
+ExtlTab ioncore_getwinprop(WClientWin *cwin)
+{
+    StringId cs[2], rs[2], is[2];
+    WClientWinIdent id;
+    ExtlTab idtab=extl_table_none();
+    ExtlTab ret=extl_table_none();
+    WWinProp **bucket, *prop;
+    int c, r, i;
+
+    if(PTRMAP_COUNT(&winprops)==0)
+        return ret;
+
+    clientwin_ident_init(cwin, &id);
+
+    cs[0]=find_id(id.cls);
+    rs[0]=find_id(id.role);
+    is[0]=find_id(id.instance);
+    cs[1]=rs[1]=is[1]=wildcard;
+
+    for(c=0; c<2; c++){
+        for(r=0; r<2; r++){
+            for(i=0; i<2; i++){
+                bucket=get_bucket(cs[c], rs[r], is[i], FALSE);
+                if(bucket==NULL)
+                    continue;
+                for(prop=*bucket; prop!=NULL; prop=prop->next){
+                    if(!match_winprop(prop, cwin, &id, &idtab))
+                        continue;
+                    ret=extl_ref_table(prop->tab);
+                    if(prop->oneshot){
+                        UNLINK_ITEM(*bucket, prop, next, prev);
+                        free_winprop(prop);
+                    }
+                    goto found;
+                }
+            }
+        }
+    }
+
+found:
+    if(idtab!=extl_table_none())
+        extl_unref_table(idtab);
+
+    clientwin_ident_deinit(&id);
+
+    return ret;
+}
+
+
+/*}}}*/
+
+
+/*{{{ Deinit */
+
+
+void ioncore_deinit_winprops()
+{
+    PtrMapIterTmp ct, rt, it;
+    PtrMap *roles, *instances;
+    WWinProp **bucket, *prop;
+
+    FOR_ALL_ON_PTRMAP(PtrMap*, roles, &winprops, ct){
+        FOR_ALL_ON_PTRMAP(PtrMap*, instances, roles, rt){
+            FOR_ALL_ON_PTRMAP(WWinProp**, bucket, instances, it){
+                while((prop=*bucket)!=NULL){
+                    UNLINK_ITEM(*bucket, prop, next, prev);
+                    free_winprop(prop);
+                }
+                stringstore_free((StringId)it.key);
+                free(bucket);
+            }
+            ptrmap_clear(instances);
+            stringstore_free((StringId)rt.key);
+            free(instances);
+        }
+        ptrmap_clear(roles);
+        stringstore_free((StringId)ct.key);
+        free(roles);
+    }
+
+    ptrmap_clear(&winprops);
+
+    if(wildcard!=STRINGID_NONE){
+        stringstore_free(wildcard);
+        wildcard=STRINGID_NONE;
+    }
+
+    if(string_find_set){
+        extl_unref_fn(string_find);
+        string_find_set=FALSE;
+    }
+}
+
+
+/*}}}*/
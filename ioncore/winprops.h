@@ -0,0 +1,19 @@
+/*
+ * notion/ioncore/winprops.h
+ *
+ * Copyright (c) 2026 The Notion development team
+ *
+ * See the included file LICENSE for details.
+ */
+
+#ifndef NOTION_IONCORE_WINPROPS_H
+#define NOTION_IONCORE_WINPROPS_H
+
+#include <libextl/extl.h>
+#include "common.h"
+
+extern void ioncore_do_defwinprop(ExtlTab tab);
+extern ExtlTab ioncore_getwinprop(WClientWin *cwin);
+extern void ioncore_deinit_winprops();
+
+#endif /* NOTION_IONCORE_WINPROPS_H */
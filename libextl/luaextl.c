@@ -19,6 +19,11 @@
 #include <limits.h>
 #include <assert.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 
 #include <lua.h>
 #include <lualib.h>
@@ -28,6 +33,8 @@
 #include <libtu/objp.h>
 #include <libtu/dlist.h>
 #include <libtu/util.h>
+#include <libtu/ptrmap.h>
+#include <libtu/stringstore.h>
 
 #include "readconfig.h"
 #include "luaextl.h"
@@ -49,6 +56,9 @@ static bool extl_stack_get(lua_State *st, int pos, char type,
 
 static int extl_protected(lua_State *st);
 
+static void extl_profiler_enter();
+static void prof_clear();
+
 #ifdef EXTL_LOG_ERRORS
 static void flushtrace();
 #else
@@ -130,6 +140,10 @@ static int extl_docpcall(lua_State *st)
 }
 
 
+/* Nesting of extl_cpcall, zero when not called from Lua. */
+static int cpcall_depth=0;
+
+
 static bool extl_cpcall(lua_State *st, ExtlCPCallFn *fn, void *ptr)
 {
     ExtlCPCallParam param;
@@ -140,6 +154,8 @@ static bool extl_cpcall(lua_State *st, ExtlCPCallFn *fn, void *ptr)
     param.udata=ptr;
     param.retval=FALSE;
 
+    extl_profiler_enter();
+    cpcall_depth++;
 
 #if LUA_VERSION_NUM>=502
     /* TODO: Call appropriate lua_checkstack!?
@@ -158,6 +174,8 @@ static bool extl_cpcall(lua_State *st, ExtlCPCallFn *fn, void *ptr)
         extl_warn(TR("Unknown Lua error."));
     }
 
+    cpcall_depth--;
+
     lua_settop(st, oldtop);
 
     return param.retval;
@@ -216,6 +234,11 @@ static Obj *extl_get_obj(lua_State *st, int pos,
 }
 
 
+/* Proxies of objects owned by the Lua side are kept in a weak table
+ * keyed by the object's address so that they may be collected. Other
+ * proxies are held by a registry reference stored in the object itself
+ * and released when the object is destroyed or uncached.
+ */
 static void extl_uncache_(lua_State *st, Obj *obj)
 {
     if(EXTL_OBJ_OWNED(obj)){
@@ -223,10 +246,9 @@ static void extl_uncache_(lua_State *st, Obj *obj)
         lua_pushlightuserdata(st, obj);
         lua_pushnil(st);
         lua_rawset(st, -3);
-    }else{
-        lua_pushlightuserdata(st, obj);
-        lua_pushnil(st);
-        lua_rawset(st, LUA_REGISTRYINDEX);
+    }else if(obj->obj_extl_ref!=0){
+        luaL_unref(st, LUA_REGISTRYINDEX, obj->obj_extl_ref);
+        obj->obj_extl_ref=0;
     }
 }
 
@@ -237,6 +259,59 @@ void extl_uncache(Obj *obj)
 }
 
 
+static void extl_proxy_dest_handler(Watch *UNUSED(proxy), Obj *obj)
+{
+    if(l_st!=NULL)
+        extl_uncache(obj);
+}
+
+
+/* Registry references to the object metatables, keyed by class
+ * descriptor, so that creating a proxy need not format and look up the
+ * metatable name. Flushed whenever a class is (un)registered.
+ */
+static PtrMap metatable_cache=PTRMAP_INIT;
+
+
+static void extl_flush_metatable_cache(lua_State *st)
+{
+    PtrMapIterTmp tmp;
+    void *ref;
+
+    FOR_ALL_ON_PTRMAP(void*, ref, &metatable_cache, tmp){
+        luaL_unref(st, LUA_REGISTRYINDEX, (int)(long)ref);
+    }
+
+    ptrmap_clear(&metatable_cache);
+}
+
+
+/* Pushes the metatable for proxies of objects of class 'descr', or nil
+ * if the class has not been registered.
+ */
+static void extl_push_metatable(lua_State *st, ClassDescr *descr)
+{
+    void *ref=ptrmap_get(&metatable_cache, descr);
+    int r;
+
+    if(ref!=NULL){
+        lua_rawgeti(st, LUA_REGISTRYINDEX, (int)(long)ref);
+        return;
+    }
+
+    lua_pushfstring(st, "luaextl_%s_metatable", descr->name);
+    lua_gettable(st, LUA_REGISTRYINDEX);
+
+    if(lua_isnil(st, -1))
+        return;
+
+    lua_pushvalue(st, -1);
+    r=luaL_ref(st, LUA_REGISTRYINDEX);
+    if(r>0 && !ptrmap_set(&metatable_cache, descr, (void*)(long)r))
+        luaL_unref(st, LUA_REGISTRYINDEX, r);
+}
+
+
 static void extl_push_obj(lua_State *st, Obj *obj)
 {
     ExtlProxy *proxy;
@@ -246,16 +321,16 @@ static void extl_push_obj(lua_State *st, Obj *obj)
         return;
     }
 
-    if(EXTL_OBJ_CACHED(obj)){
-        if(EXTL_OBJ_OWNED(obj)){
-            lua_rawgeti(st, LUA_REGISTRYINDEX, owned_cache_ref);
-            lua_pushlightuserdata(st, obj);
-            lua_rawget(st, -2);
-            lua_remove(st, -2); /* owned_cache */
-        }else{
-            lua_pushlightuserdata(st, obj);
-            lua_rawget(st, LUA_REGISTRYINDEX);
+    if(!EXTL_OBJ_OWNED(obj)){
+        if(obj->obj_extl_ref!=0){
+            lua_rawgeti(st, LUA_REGISTRYINDEX, obj->obj_extl_ref);
+            return;
         }
+    }else if(EXTL_OBJ_CACHED(obj)){
+        lua_rawgeti(st, LUA_REGISTRYINDEX, owned_cache_ref);
+        lua_pushlightuserdata(st, obj);
+        lua_rawget(st, -2);
+        lua_remove(st, -2); /* owned_cache */
         if(lua_isuserdata(st, -1)){
             D(fprintf(stderr, "found %p cached\n", obj));
             return;
@@ -269,8 +344,7 @@ static void extl_push_obj(lua_State *st, Obj *obj)
 
     /* Lua shouldn't return if the allocation fails */
 
-    lua_pushfstring(st, "luaextl_%s_metatable", OBJ_TYPESTR(obj));
-    lua_gettable(st, LUA_REGISTRYINDEX);
+    extl_push_metatable(st, obj->obj_type);
     if(lua_isnil(st, -1)){
         lua_pop(st, 2);
         lua_pushnil(st);
@@ -285,9 +359,8 @@ static void extl_push_obj(lua_State *st, Obj *obj)
             lua_rawset_check(st, -3);
             lua_pop(st, 1); /* owned_cache */
         }else{
-            lua_pushlightuserdata(st, obj);
-            lua_pushvalue(st, -2); /* the WWatch */
-            lua_rawset_check(st, LUA_REGISTRYINDEX);
+            lua_pushvalue(st, -1); /* the WWatch */
+            obj->obj_extl_ref=luaL_ref(st, LUA_REGISTRYINDEX);
         }
         EXTL_BEGIN_PROXY_OBJ(proxy, obj);
     }
@@ -626,6 +699,9 @@ bool extl_init()
 
 void extl_deinit()
 {
+    extl_profiler_stop();
+    prof_clear();
+    ptrmap_clear(&metatable_cache);
     lua_close(l_st);
     l_st=NULL;
 }
@@ -988,6 +1064,46 @@ ExtlTab extl_create_table()
 }
 
 
+typedef struct{
+    int ref;
+    ExtlTab ret;
+} CopyParams;
+
+
+static bool extl_do_copy_table(lua_State *st, CopyParams *cp)
+{
+    if(!extl_getref(st, cp->ref))
+        return FALSE;
+
+    lua_newtable(st);
+    lua_pushnil(st);
+    while(lua_next(st, -3)!=0){
+        lua_pushvalue(st, -2);
+        lua_insert(st, -2);
+        lua_rawset(st, -4);
+    }
+
+    cp->ret=luaL_ref(st, LUA_REGISTRYINDEX);
+    return TRUE;
+}
+
+
+/* Returns a new table with the same keys and values as ref; tables
+ * within ref are shared, not copied.
+ */
+ExtlTab extl_table_copy(ExtlTab ref)
+{
+    CopyParams cp;
+
+    cp.ref=ref;
+    cp.ret=LUA_NOREF;
+
+    if(extl_cpcall(l_st, (ExtlCPCallFn*)extl_do_copy_table, &cp))
+        return cp.ret;
+    return LUA_NOREF;
+}
+
+
 /* eq */
 
 typedef struct{
@@ -1335,6 +1451,141 @@ bool extl_table_seti_t(ExtlTab ref, int entry, ExtlTab val)
 /*}}}*/
 
 
+/*{{{ Table/many */
+
+
+/* The functions in this section access several string-keyed fields in
+ * one protected call. 'spec' has one type character per field, and the
+ * variable arguments are the pairs (key, value) or (key, return pointer)
+ * in the same order.
+ */
+
+typedef struct{
+    ExtlTab ref;
+    bool create;
+    const char *spec;
+    va_list *argsp;
+    uint found;
+} TableManyParams;
+
+
+static bool extl_table_do_sets_many(lua_State *st, TableManyParams *params)
+{
+    const char *spec;
+
+    if(params->create){
+        lua_newtable(st);
+    }else{
+        if(params->ref<0)
+            return FALSE;
+        lua_rawgeti(st, LUA_REGISTRYINDEX, params->ref);
+    }
+
+    for(spec=params->spec; *spec!='\0'; spec++){
+        lua_pushstring(st, va_arg(*(params->argsp), const char*));
+        extl_stack_push_vararg(st, *spec, params->argsp);
+        lua_rawset_check(st, -3);
+    }
+
+    if(params->create)
+        params->ref=luaL_ref(st, LUA_REGISTRYINDEX);
+
+    return TRUE;
+}
+
+
+static bool extl_table_do_gets_many(lua_State *st, TableManyParams *params)
+{
+    const char *spec;
+    uint bit=1;
+
+    if(params->ref<0)
+        return FALSE;
+
+    lua_rawgeti(st, LUA_REGISTRYINDEX, params->ref);
+
+    for(spec=params->spec; *spec!='\0'; spec++, bit<<=1){
+        const char *key=va_arg(*(params->argsp), const char*);
+        void *valret=va_arg(*(params->argsp), void*);
+
+        lua_pushstring(st, key);
+        lua_gettable(st, -2);
+        if(!lua_isnil(st, -1)
+           && extl_stack_get(st, -1, *spec, TRUE, NULL, valret)){
+            params->found|=bit;
+        }
+        lua_pop(st, 1);
+    }
+
+    return TRUE;
+}
+
+
+/* Set the fields, as with extl_table_sets_*. A NULL string or object,
+ * or a null table or function reference, leaves the field unset.
+ */
+bool extl_table_sets_many(ExtlTab ref, const char *spec, ...)
+{
+    TableManyParams params;
+    va_list args;
+    bool retval;
+
+    va_start(args, spec);
+    params.ref=ref;
+    params.create=FALSE;
+    params.spec=spec;
+    params.argsp=&args;
+    retval=extl_cpcall(l_st, (ExtlCPCallFn*)extl_table_do_sets_many, &params);
+    va_end(args);
+
+    return retval;
+}
+
+
+/* Create a new table with the given fields set. */
+ExtlTab extl_create_table_with(const char *spec, ...)
+{
+    TableManyParams params;
+    va_list args;
+
+    va_start(args, spec);
+    params.ref=LUA_NOREF;
+    params.create=TRUE;
+    params.spec=spec;
+    params.argsp=&args;
+    if(!extl_cpcall(l_st, (ExtlCPCallFn*)extl_table_do_sets_many, &params))
+        params.ref=LUA_NOREF;
+    va_end(args);
+
+    return params.ref;
+}
+
+
+/* Get the fields, as with extl_table_gets_*; the return pointers of
+ * missing fields are left untouched. Bit i of the return value is set
+ * when field i was found, so 'spec' may be at most 32 characters long.
+ */
+uint extl_table_gets_many(ExtlTab ref, const char *spec, ...)
+{
+    TableManyParams params;
+    va_list args;
+
+    va_start(args, spec);
+    params.ref=ref;
+    params.create=FALSE;
+    params.spec=spec;
+    params.argsp=&args;
+    params.found=0;
+    extl_cpcall(l_st, (ExtlCPCallFn*)extl_table_do_gets_many, &params);
+    va_end(args);
+
+    return params.found;
+}
+
+
+/*}}}*/
+
+
 /*{{{ Table/clear entry */
 
 
@@ -2024,6 +2275,94 @@ static int extl_l1_call_handler(lua_State *st)
 }
 
 
+/* Functions whose arguments and results need no cleanup--no references
+ * to tables and functions nor strings to free--are called without the
+ * protected second step: the arguments are converted before anything
+ * is set up that an error could leak, and the result is pushed after
+ * that has been torn down. This is decided once at registration.
+ */
+static bool extl_l1_is_fast(ExtlExportedFnSpec *spec)
+{
+    const char *p;
+
+    if(spec->ispec!=NULL){
+        for(p=spec->ispec; *p!='\0'; p++){
+            if(strchr("idbosS", *p)==NULL)
+                return FALSE;
+        }
+    }
+
+    if(spec->ospec!=NULL && spec->ospec[0]!='\0'){
+        if(spec->ospec[1]!='\0' || strchr("idboS", spec->ospec[0])==NULL)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+static int extl_l1_fast_call_handler(lua_State *st)
+{
+#ifdef EXTL_LOG_ERRORS
+    WarnChain ch;
+#endif
+    ExtlL2Param ip[MAX_PARAMS], op[1];
+    ExtlExportedFnSpec *spec;
+    bool ok;
+    int i;
+
+    spec=(ExtlExportedFnSpec*)lua_touserdata(st, lua_upvalueindex(1));
+
+    /* Leave unusual situations and argument errors to the general
+     * handler, which also reports them.
+     */
+    if(spec==NULL || !spec->registered || extl_l1_just_check_protected
+       || !extl_check_protected(spec)){
+        return extl_l1_call_handler(st);
+    }
+
+    if(spec->ispec!=NULL){
+        for(i=0; spec->ispec[i]!='\0'; i++){
+            if(!extl_stack_get(st, i+1, spec->ispec[i], FALSE, NULL, &ip[i]))
+                return extl_l1_call_handler(st);
+        }
+    }
+
+    D(fprintf(stderr, "%s called\n", spec->name));
+
+#ifdef EXTL_LOG_ERRORS
+    ch.old_handler=set_warn_handler(l1_warn_handler);
+    ch.need_trace=FALSE;
+    ch.st=st;
+    ch.prev=warnchain;
+    warnchain=&ch;
+#endif
+
+    if(spec->untraced)
+        notrace++;
+
+    ok=spec->l2handler(spec->fn, ip, op);
+
+    if(spec->untraced)
+        notrace--;
+
+#ifdef EXTL_LOG_ERRORS
+    warnchain=ch.prev;
+    set_warn_handler(ch.old_handler);
+
+    if(ch.need_trace)
+        do_trace(&ch);
+#endif
+
+    if(!ok || spec->ospec==NULL || spec->ospec[0]=='\0')
+        return 0;
+
+    extl_stack_push(st, spec->ospec[0], (void*)&op[0]);
+
+    return 1;
+}
+
+
 /*EXTL_DOC
  * Is calling the function \var{fn} not allowed now? If \var{fn} is nil,
  * tells if some functions are not allowed to be called now due to
@@ -2046,7 +2385,8 @@ static int extl_protected(lua_State *st)
         return 1;
     }
 
-    if(lua_tocfunction(st, 1)!=(lua_CFunction)extl_l1_call_handler){
+    if(lua_tocfunction(st, 1)!=(lua_CFunction)extl_l1_call_handler &&
+       lua_tocfunction(st, 1)!=(lua_CFunction)extl_l1_fast_call_handler){
         lua_pushboolean(st, FALSE);
         return 1;
     }
@@ -2102,7 +2442,9 @@ static bool extl_do_register_function(lua_State *st, RegData *data)
     lua_pushstring(st, spec->name);
 
     lua_pushlightuserdata(st, spec);
-    lua_pushcclosure(st, extl_l1_call_handler, 1);
+    lua_pushcclosure(st, (extl_l1_is_fast(spec)
+                          ? extl_l1_fast_call_handler
+                          : extl_l1_call_handler), 1);
 
     lua_rawset_check(st, ind);
 
@@ -2174,6 +2516,10 @@ static bool extl_do_unregister_function(lua_State *st, RegData *data)
 }
 
 
+/* Counts unregistrations to tell when ExtlDirectFns may be stale. */
+static int unregister_count=0;
+
+
 static void extl_do_unregister_functions(ExtlExportedFnSpec *spec, int max,
                                          const char *cls, int table)
 {
@@ -2190,6 +2536,8 @@ static void extl_do_unregister_functions(ExtlExportedFnSpec *spec, int max,
                     &regdata);
         spec[i].registered=FALSE;
     }
+
+    unregister_count++;
 }
 
 void extl_unregister_function(ExtlExportedFnSpec *spec)
@@ -2306,6 +2654,8 @@ static bool extl_do_register_class(lua_State *st, ClassData *data)
     lua_insert(st, -2);
     lua_rawset(st, LUA_REGISTRYINDEX);
 
+    extl_flush_metatable_cache(st);
+
     return TRUE;
 }
 
@@ -2345,6 +2695,7 @@ static void extl_do_unregister_class(lua_State *st, ClassData *data)
     /* Set the entry from registry to nil. */
     lua_pushnil(st);
     lua_rawset(st, LUA_REGISTRYINDEX);
+    extl_flush_metatable_cache(st);
 
     /* Reset the global reference to the class to nil. */
 #if LUA_VERSION_NUM>=502
@@ -2369,6 +2720,9 @@ void extl_unregister_class(const char *cls, ExtlExportedFnSpec *fns)
     clsdata.refret=LUA_NOREF;
     clsdata.hide=FALSE; /* unused, but initialise */
 
+    /* The class's dynfun dispatch tables may be going away with it. */
+    flush_dynfun_dispatch();
+
     if(!extl_cpcall(l_st, (ExtlCPCallFn*)extl_do_unregister_class,
                     &clsdata))
         return;
@@ -2444,6 +2798,8 @@ void extl_unregister_module(const char *mdl, ExtlExportedFnSpec *fns)
     clsdata.refret=LUA_NOREF;
     clsdata.hide=FALSE; /* unused, but initialise */
 
+    flush_dynfun_dispatch();
+
     if(!extl_cpcall(l_st, (ExtlCPCallFn*)extl_do_unregister_module, &clsdata))
         return;
 
@@ -2455,49 +2811,250 @@ void extl_unregister_module(const char *mdl, ExtlExportedFnSpec *fns)
 /*}}}*/
 
 
-/*{{{ Serialise */
+/*{{{ Direct calls to exported functions */
+
+
+/* Exported functions whose arguments and result need no cleanup can be
+ * called from C with level 2 parameters, without entering Lua. A spec
+ * may go away with the module that unregistered it, so handles are
+ * only good until the next unregistration. The name may also be given
+ * a Lua function in its place, so each call checks that it still
+ * resolves to the function looked up.
+ */
+
+#define DIRECT_MAX_DEPTH 16
+
 
 typedef struct{
-    FILE *f;
-    ExtlTab tab;
-} SerData;
+    const char *tab;
+    const char *name;
+    ExtlExportedFnSpec *spec;
+    int tabref, nameref;
+} LookupParam;
 
 
-static void write_escaped_string(FILE *f, const char *str)
+/* The spec of the exported function at the top of the stack, or NULL. */
+static ExtlExportedFnSpec *extl_exported_spec(lua_State *st)
 {
-    fputc('"', f);
+    lua_CFunction cf=lua_tocfunction(st, -1);
+    ExtlExportedFnSpec *spec;
 
-    while(str && *str){
-        if(((*str)&0x7f)<32 || *str=='"' || *str=='\\'){
-            /* Lua uses decimal in escapes */
-            fprintf(f, "\\%03d", (int)(uchar)(*str));
-        }else{
-            fputc(*str, f);
-        }
-        str++;
+    if(cf!=(lua_CFunction)extl_l1_call_handler &&
+       cf!=(lua_CFunction)extl_l1_fast_call_handler){
+        return NULL;
     }
 
-    fputc('"', f);
-}
+    if(lua_getupvalue(st, -1, 1)==NULL)
+        return NULL;
 
+    spec=(ExtlExportedFnSpec*)lua_touserdata(st, -1);
+    lua_pop(st, 1);
 
-static void indent(FILE *f, int lvl)
-{
-    int i;
-    for(i=0; i<lvl; i++)
-        fprintf(f, "    ");
+    return spec;
 }
 
 
-static bool ser(lua_State *st, FILE *f, int lvl)
+static bool extl_do_lookup_exported(lua_State *st, LookupParam *p)
 {
+#if LUA_VERSION_NUM>=502
+    lua_pushglobaltable(st);
+#else
+    lua_pushvalue(st, LUA_GLOBALSINDEX);
+#endif
 
-    lua_checkstack(st, 5);
+    if(p->tab!=NULL){
+        lua_getfield(st, -1, p->tab);
+        if(!lua_istable(st, -1))
+            return FALSE;
+    }
 
-    switch(lua_type(st, -1)){
-    case LUA_TBOOLEAN:
-        fprintf(f, "%s", lua_toboolean(st, -1) ? "true" : "false");
-        break;
+    lua_getfield(st, -1, p->name);
+
+    p->spec=extl_exported_spec(st);
+
+    if(p->spec==NULL || !extl_l1_is_fast(p->spec))
+        return FALSE;
+
+    /* Kept as references, so that checking them allocates nothing. */
+    if(p->tab!=NULL){
+        lua_pushstring(st, p->tab);
+        p->tabref=luaL_ref(st, LUA_REGISTRYINDEX);
+    }
+
+    lua_pushstring(st, p->name);
+    p->nameref=luaL_ref(st, LUA_REGISTRYINDEX);
+
+    return TRUE;
+}
+
+
+/* Does the name \var{fn} was looked up by still resolve to it? Only raw
+ * accesses are made, as this is not a protected call, so an __index
+ * function on the way counts as a change.
+ */
+static bool extl_direct_current(const ExtlDirectFn *fn)
+{
+    lua_State *st=l_st;
+    int top=lua_gettop(st), i;
+    bool ret=FALSE;
+
+#if LUA_VERSION_NUM>=502
+    lua_rawgeti(st, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS);
+#else
+    lua_pushvalue(st, LUA_GLOBALSINDEX);
+#endif
+
+    if(fn->tabref!=LUA_NOREF){
+        lua_rawgeti(st, LUA_REGISTRYINDEX, fn->tabref);
+        lua_rawget(st, -2);
+    }
+
+    /* Follow __index tables as class tables inherit through them. */
+    for(i=0; i<DIRECT_MAX_DEPTH && lua_istable(st, -1); i++){
+        lua_rawgeti(st, LUA_REGISTRYINDEX, fn->nameref);
+        lua_rawget(st, -2);
+        if(!lua_isnil(st, -1)){
+            ret=(extl_exported_spec(st)==fn->spec);
+            break;
+        }
+        lua_pop(st, 1);
+        if(!lua_getmetatable(st, -1))
+            break;
+        lua_pushliteral(st, "__index");
+        lua_rawget(st, -2);
+        lua_remove(st, -2);
+        lua_remove(st, -2);
+    }
+
+    lua_settop(st, top);
+
+    return ret;
+}
+
+
+/* Look up the exported function \var{tab}.\var{name}, or the global
+ * \var{name} if \var{tab} is NULL. Fails if it is not an exported function
+ * or its parameters need cleanup after the call.
+ */
+bool extl_lookup_direct(const char *tab, const char *name, ExtlDirectFn *ret)
+{
+    LookupParam p;
+
+    p.tab=tab;
+    p.name=name;
+    p.spec=NULL;
+    p.tabref=LUA_NOREF;
+    p.nameref=LUA_NOREF;
+
+    if(!extl_cpcall(l_st, (ExtlCPCallFn*)extl_do_lookup_exported, &p))
+        return FALSE;
+
+    ret->spec=p.spec;
+    ret->unregister_count=unregister_count;
+    ret->tabref=p.tabref;
+    ret->nameref=p.nameref;
+
+    return TRUE;
+}
+
+
+/* Release a handle from extl_lookup_direct. */
+void extl_free_direct(ExtlDirectFn *fn)
+{
+    if(fn->spec==NULL)
+        return;
+
+    if(fn->tabref!=LUA_NOREF)
+        extl_cpcall(l_st, (ExtlCPCallFn*)extl_do_unref, &fn->tabref);
+    extl_cpcall(l_st, (ExtlCPCallFn*)extl_do_unref, &fn->nameref);
+
+    fn->spec=NULL;
+}
+
+
+/* Can \var{fn} be called directly now? If not, call it through Lua
+ * instead, which also reports why it can not be called.
+ */
+bool extl_direct_ok(const ExtlDirectFn *fn)
+{
+    return (fn->spec!=NULL
+            && fn->unregister_count==unregister_count
+            && fn->spec->registered
+            && extl_check_protected(fn->spec)
+            && extl_direct_current(fn));
+}
+
+
+/* Call \var{fn}, which must be extl_direct_ok, with \var{in} converted
+ * as its input specification says. \var{out} must have room for one
+ * result.
+ */
+bool extl_call_direct(const ExtlDirectFn *fn, ExtlL2Param *in,
+                      ExtlL2Param *out)
+{
+    ExtlExportedFnSpec *spec=fn->spec;
+    bool ret;
+
+    D(fprintf(stderr, "%s called directly\n", spec->name));
+
+    if(spec->untraced)
+        notrace++;
+
+    ret=spec->l2handler(spec->fn, in, out);
+
+    if(spec->untraced)
+        notrace--;
+
+    return ret;
+}
+
+
+/*}}}*/
+
+
+/*{{{ Serialise */
+
+typedef struct{
+    FILE *f;
+    ExtlTab tab;
+} SerData;
+
+
+static void write_escaped_string(FILE *f, const char *str)
+{
+    fputc('"', f);
+
+    while(str && *str){
+        if(((*str)&0x7f)<32 || *str=='"' || *str=='\\'){
+            /* Lua uses decimal in escapes */
+            fprintf(f, "\\%03d", (int)(uchar)(*str));
+        }else{
+            fputc(*str, f);
+        }
+        str++;
+    }
+
+    fputc('"', f);
+}
+
+
+static void indent(FILE *f, int lvl)
+{
+    int i;
+    for(i=0; i<lvl; i++)
+        fprintf(f, "    ");
+}
+
+
+static bool ser(lua_State *st, FILE *f, int lvl)
+{
+
+    lua_checkstack(st, 5);
+
+    switch(lua_type(st, -1)){
+    case LUA_TBOOLEAN:
+        fprintf(f, "%s", lua_toboolean(st, -1) ? "true" : "false");
+        break;
     case LUA_TNUMBER:
         fprintf(f, "%s", lua_tostring(st, -1));
         break;
@@ -2594,6 +3151,494 @@ extern bool extl_serialize(const char *file, ExtlTab tab)
     return ret;
 }
 
+
+/* Binary savefiles hold the same tables as extl_serialize writes, as a
+ * header followed by one value. Values are a tag byte and its data:
+ *
+ *   nil, false, true   nothing
+ *   integer            zigzag varint
+ *   number             IEEE double, little endian
+ *   string             varint length and the bytes
+ *   table              varints for the array size and the number of
+ *                      pairs, followed by the keys and values
+ *
+ * The header holds the payload length and its FNV-1a hash, so that
+ * truncated or damaged files are rejected before anything is built.
+ * Files are read through mmap with strings going to Lua straight from
+ * the mapping, and tables are created at their final size.
+ */
+
+#define BIN_MAGIC "\033ExtlSav"
+#define BIN_MAGIC_LEN 8
+#define BIN_VERSION 1
+#define BIN_HDR_SIZE 24
+
+enum{
+    BIN_NIL,
+    BIN_FALSE,
+    BIN_TRUE,
+    BIN_INT,
+    BIN_NUM,
+    BIN_STR,
+    BIN_TAB
+};
+
+
+typedef struct{
+    uchar *data;
+    size_t len, size;
+    bool failed;
+    ExtlTab tab;
+} BinBuf;
+
+
+typedef struct{
+    const uchar *p, *end;
+    ExtlTab *ret;
+} BinReader;
+
+
+static uint32_t bin_hash(const uchar *p, size_t len)
+{
+    uint32_t h=2166136261U;
+
+    while(len-->0){
+        h^=*p++;
+        h*=16777619U;
+    }
+
+    return h;
+}
+
+
+static void bin_put(BinBuf *b, const void *p, size_t n)
+{
+    size_t size;
+    uchar *data;
+
+    if(b->failed)
+        return;
+
+    if(b->len+n>b->size){
+        size=(b->size==0 ? 4096 : b->size);
+        while(size<b->len+n)
+            size*=2;
+        data=(uchar*)realloc(b->data, size);
+        if(data==NULL){
+            b->failed=TRUE;
+            return;
+        }
+        b->data=data;
+        b->size=size;
+    }
+
+    memcpy(b->data+b->len, p, n);
+    b->len+=n;
+}
+
+
+static void bin_put_byte(BinBuf *b, int c)
+{
+    uchar u=(uchar)c;
+    bin_put(b, &u, 1);
+}
+
+
+static void bin_put_varint(BinBuf *b, uint64_t v)
+{
+    uchar buf[10];
+    int n=0;
+
+    while(v>=0x80){
+        buf[n++]=(uchar)(v|0x80);
+        v>>=7;
+    }
+    buf[n++]=(uchar)v;
+
+    bin_put(b, buf, n);
+}
+
+
+static void bin_set_le(uchar *p, uint64_t v, int n)
+{
+    int i;
+    for(i=0; i<n; i++)
+        p[i]=(uchar)(v>>(8*i));
+}
+
+
+static uint64_t bin_get_le(const uchar *p, int n)
+{
+    uint64_t v=0;
+    int i;
+    for(i=0; i<n; i++)
+        v|=(uint64_t)p[i]<<(8*i);
+    return v;
+}
+
+
+static void bin_put_int(BinBuf *b, int64_t i)
+{
+    bin_put_byte(b, BIN_INT);
+    bin_put_varint(b, (i<0 ? ~((uint64_t)i<<1) : (uint64_t)i<<1));
+}
+
+
+static void bin_put_number(lua_State *st, BinBuf *b)
+{
+    lua_Number n=lua_tonumber(st, -1);
+    double d=(double)n;
+    uchar buf[8];
+    uint64_t u;
+
+#if LUA_VERSION_NUM>=503
+    if(lua_isinteger(st, -1)){
+        bin_put_int(b, (int64_t)lua_tointeger(st, -1));
+        return;
+    }
+#else
+    if(d==floor(d) && fabs(d)<9007199254740992.0 && !(d==0 && signbit(d))){
+        bin_put_int(b, (int64_t)d);
+        return;
+    }
+#endif
+
+    memcpy(&u, &d, 8);
+    bin_set_le(buf, u, 8);
+    bin_put_byte(b, BIN_NUM);
+    bin_put(b, buf, 8);
+}
+
+
+static void bin_ser(lua_State *st, BinBuf *b, int lvl)
+{
+    const char *s;
+    size_t len, narr, npairs;
+
+    lua_checkstack(st, 5);
+
+    switch(lua_type(st, -1)){
+    case LUA_TBOOLEAN:
+        bin_put_byte(b, lua_toboolean(st, -1) ? BIN_TRUE : BIN_FALSE);
+        break;
+    case LUA_TNUMBER:
+        bin_put_number(st, b);
+        break;
+    case LUA_TNIL:
+        bin_put_byte(b, BIN_NIL);
+        break;
+    case LUA_TSTRING:
+        s=lua_tolstring(st, -1, &len);
+        bin_put_byte(b, BIN_STR);
+        bin_put_varint(b, len);
+        bin_put(b, s, len);
+        break;
+    case LUA_TTABLE:
+        if(lvl+1>=EXTL_MAX_SERIALISE_DEPTH){
+            extl_warn(TR("Maximal serialisation depth reached."));
+            bin_put_byte(b, BIN_NIL);
+            break;
+        }
+
+        npairs=0;
+        lua_pushnil(st);
+        while(lua_next(st, -2)!=0){
+            npairs++;
+            lua_pop(st, 1);
+        }
+        narr=lua_objlen_check(st, -1);
+
+        bin_put_byte(b, BIN_TAB);
+        bin_put_varint(b, (narr<npairs ? narr : npairs));
+        bin_put_varint(b, npairs);
+
+        lua_pushnil(st);
+        while(lua_next(st, -2)!=0){
+            lua_pushvalue(st, -2);
+            bin_ser(st, b, lvl+1);
+            bin_ser(st, b, lvl+1);
+        }
+        break;
+    default:
+        extl_warn(TR("Unable to serialize type %s."),
+                  lua_typename(st, lua_type(st, -1)));
+        bin_put_byte(b, BIN_NIL);
+    }
+    lua_pop(st, 1);
+}
+
+
+static bool bin_get_varint(BinReader *r, uint64_t *ret)
+{
+    uint64_t v=0;
+    int shift=0;
+    uchar c;
+
+    while(r->p<r->end && shift<64){
+        c=*(r->p++);
+        v|=(uint64_t)(c&0x7f)<<shift;
+        if(!(c&0x80)){
+            *ret=v;
+            return TRUE;
+        }
+        shift+=7;
+    }
+
+    return FALSE;
+}
+
+
+static bool bin_is_key(lua_State *st, int pos)
+{
+    lua_Number n;
+
+    if(lua_isnil(st, pos))
+        return FALSE;
+
+    if(lua_type(st, pos)==LUA_TNUMBER){
+        n=lua_tonumber(st, pos);
+        return (n==n);
+    }
+
+    return TRUE;
+}
+
+
+static bool bin_unser(lua_State *st, BinReader *r, int lvl)
+{
+    uint64_t u, narr, npairs, i;
+    double d;
+
+    if(r->p>=r->end || lvl>=EXTL_MAX_SERIALISE_DEPTH
+       || !lua_checkstack(st, 4)){
+        return FALSE;
+    }
+
+    switch(*(r->p++)){
+    case BIN_NIL:
+        lua_pushnil(st);
+        return TRUE;
+    case BIN_FALSE:
+        lua_pushboolean(st, FALSE);
+        return TRUE;
+    case BIN_TRUE:
+        lua_pushboolean(st, TRUE);
+        return TRUE;
+    case BIN_INT:
+        if(!bin_get_varint(r, &u))
+            return FALSE;
+        u=(u&1 ? ~(u>>1) : u>>1);
+#if LUA_VERSION_NUM>=503
+        lua_pushinteger(st, (lua_Integer)(int64_t)u);
+#else
+        lua_pushnumber(st, (lua_Number)(int64_t)u);
+#endif
+        return TRUE;
+    case BIN_NUM:
+        if(r->end-r->p<8)
+            return FALSE;
+        u=bin_get_le(r->p, 8);
+        r->p+=8;
+        memcpy(&d, &u, 8);
+        lua_pushnumber(st, d);
+        return TRUE;
+    case BIN_STR:
+        if(!bin_get_varint(r, &u) || u>(uint64_t)(r->end-r->p))
+            return FALSE;
+        lua_pushlstring(st, (const char*)r->p, u);
+        r->p+=u;
+        return TRUE;
+    case BIN_TAB:
+        if(!bin_get_varint(r, &narr) || !bin_get_varint(r, &npairs))
+            return FALSE;
+        /* Each pair takes at least two bytes. */
+        if(narr>npairs || npairs>(uint64_t)(r->end-r->p)/2
+           || npairs>INT_MAX){
+            return FALSE;
+        }
+        lua_createtable(st, (int)narr, (int)(npairs-narr));
+        for(i=0; i<npairs; i++){
+            if(!bin_unser(st, r, lvl+1) || !bin_unser(st, r, lvl+1))
+                return FALSE;
+            if(bin_is_key(st, -2) && !lua_isnil(st, -1))
+                lua_rawset(st, -3);
+            else
+                lua_pop(st, 2);
+        }
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+static bool extl_do_serialize_binary(lua_State *st, BinBuf *b)
+{
+    if(!extl_getref(st, b->tab))
+        return FALSE;
+
+    bin_ser(st, b, 0);
+
+    return !b->failed;
+}
+
+
+static bool extl_do_unserialize_binary(lua_State *st, BinReader *r)
+{
+    if(!bin_unser(st, r, 0) || r->p!=r->end || !lua_istable(st, -1))
+        return FALSE;
+
+    *(r->ret)=luaL_ref(st, LUA_REGISTRYINDEX);
+
+    return TRUE;
+}
+
+
+static bool write_all(int fd, const uchar *p, size_t len)
+{
+    ssize_t n;
+
+    while(len>0){
+        n=write(fd, p, len);
+        if(n<0){
+            if(errno==EINTR)
+                continue;
+            return FALSE;
+        }
+        p+=n;
+        len-=n;
+    }
+
+    return TRUE;
+}
+
+
+/* Write tab in the binary format. The file is replaced atomically. Tab
+ * must not contain recursive references!
+ */
+bool extl_serialize_binary(const char *file, ExtlTab tab)
+{
+    BinBuf b;
+    bool ret;
+    int fd;
+    char tmp_file[strlen(file)+8];
+
+    b.data=NULL;
+    b.len=0;
+    b.size=0;
+    b.failed=FALSE;
+    b.tab=tab;
+
+    /* Room for the header. */
+    bin_put(&b, BIN_MAGIC, BIN_MAGIC_LEN);
+    bin_put(&b, "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0",
+            BIN_HDR_SIZE-BIN_MAGIC_LEN);
+
+    ret=extl_cpcall(l_st, (ExtlCPCallFn*)extl_do_serialize_binary, &b);
+
+    if(!ret || b.failed){
+        if(b.failed)
+            extl_warn("%s", strerror(ENOMEM));
+        free(b.data);
+        return FALSE;
+    }
+
+    bin_set_le(b.data+BIN_MAGIC_LEN, BIN_VERSION, 4);
+    bin_set_le(b.data+BIN_MAGIC_LEN+4,
+               bin_hash(b.data+BIN_HDR_SIZE, b.len-BIN_HDR_SIZE), 4);
+    bin_set_le(b.data+BIN_MAGIC_LEN+8, b.len-BIN_HDR_SIZE, 8);
+
+    strcpy(tmp_file, file);
+    strcat(tmp_file, ".XXXXXX");
+    fd=mkstemp(tmp_file);
+    if(fd==-1){
+        extl_warn_err_obj(tmp_file);
+        free(b.data);
+        return FALSE;
+    }
+
+    ret=(write_all(fd, b.data, b.len) && fsync(fd)==0);
+
+    if(close(fd)!=0)
+        ret=FALSE;
+
+    if(!ret)
+        extl_warn_err_obj(tmp_file);
+
+    free(b.data);
+
+    if(ret && rename(tmp_file, file)!=0){
+        extl_warn_err_obj(file);
+        ret=FALSE;
+    }
+
+    if(!ret)
+        unlink(tmp_file);
+
+    return ret;
+}
+
+
+/* Read a table written by extl_serialize_binary. Returns FALSE without
+ * creating anything if the file is not a valid binary savefile.
+ */
+bool extl_unserialize_binary(const char *file, ExtlTab *ret)
+{
+    BinReader r;
+    struct stat st;
+    const uchar *data;
+    uint64_t len;
+    bool ok=FALSE;
+    int fd;
+
+    fd=open(file, O_RDONLY);
+    if(fd<0){
+        extl_warn_err_obj(file);
+        return FALSE;
+    }
+
+    if(fstat(fd, &st)!=0){
+        extl_warn_err_obj(file);
+        close(fd);
+        return FALSE;
+    }
+
+    if(st.st_size<BIN_HDR_SIZE){
+        close(fd);
+        extl_warn(TR("\"%s\" is not a valid savefile."), file);
+        return FALSE;
+    }
+
+    data=(const uchar*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data==MAP_FAILED){
+        extl_warn_err_obj(file);
+        return FALSE;
+    }
+
+    len=bin_get_le(data+BIN_MAGIC_LEN+8, 8);
+
+    if(memcmp(data, BIN_MAGIC, BIN_MAGIC_LEN)==0
+       && bin_get_le(data+BIN_MAGIC_LEN, 4)==BIN_VERSION
+       && len==(uint64_t)st.st_size-BIN_HDR_SIZE
+       && bin_get_le(data+BIN_MAGIC_LEN+4, 4)==bin_hash(data+BIN_HDR_SIZE,
+                                                         len)){
+        r.p=data+BIN_HDR_SIZE;
+        r.end=r.p+len;
+        r.ret=ret;
+        ok=extl_cpcall(l_st, (ExtlCPCallFn*)extl_do_unserialize_binary, &r);
+    }
+
+    munmap((void*)data, st.st_size);
+
+    if(!ok)
+        extl_warn(TR("\"%s\" is not a valid savefile."), file);
+
+    return ok;
+}
+
+
 void extl_dohook(lua_State *L, lua_Debug *ar)
 {
     enum ExtlHookEvent event;
@@ -2623,6 +3668,253 @@ void extl_resethook()
 
 /*}}}*/
 
+
+/*{{{ Sampling profiler */
+
+
+/* A count hook samples the Lua call stack every 'interval' instructions.
+ * Each sample is weighted by the time since the previous one, or since
+ * Lua was entered from C, so time spent in C functions called from Lua is
+ * charged to the calling Lua stack. Stacks are kept folded root first,
+ * interned in the stringstore and summed per stack. Only the main thread
+ * and coroutines created after starting are sampled, and LuaJIT runs
+ * compiled traces without count hooks.
+ */
+
+#define PROF_DEFAULT_INTERVAL 1000
+#define PROF_MAX_DEPTH 64
+#define PROF_BUFSIZE 4096
+
+INTRSTRUCT(ExtlProfStack);
+
+DECLSTRUCT(ExtlProfStack){
+    StringId id;
+    double ns;
+    ulong samples;
+};
+
+static PtrMap prof_stacks=PTRMAP_INIT;
+static bool prof_running=FALSE;
+static double prof_last=0;
+
+
+static double prof_now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec*1e9+tv.tv_usec*1e3;
+}
+
+
+static void extl_profiler_enter()
+{
+    if(prof_running && cpcall_depth==0)
+        prof_last=prof_now();
+}
+
+
+static void prof_clear()
+{
+    PtrMapIterTmp tmp;
+    ExtlProfStack *ps;
+
+    FOR_ALL_ON_PTRMAP(ExtlProfStack*, ps, &prof_stacks, tmp){
+        stringstore_free(ps->id);
+        free(ps);
+    }
+
+    ptrmap_clear(&prof_stacks);
+}
+
+
+static int prof_frame(lua_Debug *ar, char *buf, int left)
+{
+    const char *name;
+    int i, n;
+
+    name=(ar->name!=NULL ? ar->name : "?");
+
+    if(*ar->what=='C')
+        n=snprintf(buf, left, "%s", (ar->name!=NULL ? name : "[C]"));
+    else if(*ar->what=='m')
+        n=snprintf(buf, left, "main@%s", ar->short_src);
+    else
+        n=snprintf(buf, left, "%s@%s:%d", name, ar->short_src,
+                   ar->linedefined);
+
+    /* Chunks loaded from strings have code for a name. */
+    for(i=0; i<n && i<left; i++){
+        if(buf[i]==';')
+            buf[i]=',';
+    }
+
+    return n;
+}
+
+
+static void prof_hook(lua_State *st, lua_Debug *UNUSED(hookar))
+{
+    lua_Debug ar[PROF_MAX_DEPTH], more;
+    char buf[PROF_BUFSIZE];
+    ExtlProfStack *ps=NULL;
+    StringId id;
+    double now;
+    int depth=0, len=0, n;
+
+    /* Coroutines created while running inherit the hook, and stopping
+     * only removes it from the main thread.
+     */
+    if(!prof_running){
+        lua_sethook(st, NULL, 0, 0);
+        return;
+    }
+
+    now=prof_now();
+
+    while(depth<PROF_MAX_DEPTH && lua_getstack(st, depth, &ar[depth]))
+        depth++;
+
+    if(depth==PROF_MAX_DEPTH && lua_getstack(st, depth, &more))
+        len=snprintf(buf, sizeof(buf), "...;");
+
+    /* The C functions Lua was entered through are left out, and frames
+     * that do not fit are dropped from the leaf end.
+     */
+    while(--depth>=0){
+        lua_getinfo(st, "Sn", &ar[depth]);
+        if(len==0 && *ar[depth].what=='C')
+            continue;
+        n=prof_frame(&ar[depth], buf+len, sizeof(buf)-len);
+        if(n<0 || len+n+1>=(int)sizeof(buf))
+            break;
+        len+=n;
+        buf[len++]=';';
+    }
+
+    if(len==0)
+        return;
+
+    buf[len-1]='\0';
+
+    id=stringstore_find(buf);
+    if(id!=NULL)
+        ps=(ExtlProfStack*)ptrmap_get(&prof_stacks, id);
+
+    if(ps==NULL){
+        ps=ALLOC(ExtlProfStack);
+        if(ps==NULL)
+            return;
+        ps->id=stringstore_alloc(buf);
+        if(ps->id==NULL || !ptrmap_set(&prof_stacks, ps->id, ps)){
+            stringstore_free(ps->id);
+            free(ps);
+            return;
+        }
+    }
+
+    /* gettimeofday may be stepped back. */
+    if(now>prof_last)
+        ps->ns+=now-prof_last;
+    ps->samples++;
+    prof_last=prof_now();
+}
+
+
+/* Start sampling every 'interval' Lua instructions (a default if not
+ * positive), discarding samples from an earlier run. Fails if another
+ * hook is installed.
+ */
+bool extl_profiler_start(int interval)
+{
+    lua_Hook hook=lua_gethook(l_st);
+
+    if(hook!=NULL && hook!=prof_hook){
+        extl_warn(TR("Another Lua hook is already installed."));
+        return FALSE;
+    }
+
+    prof_clear();
+
+    if(interval<=0)
+        interval=PROF_DEFAULT_INTERVAL;
+
+    lua_sethook(l_st, prof_hook, LUA_MASKCOUNT, interval);
+    prof_running=TRUE;
+    prof_last=prof_now();
+
+    return TRUE;
+}
+
+
+/* Stop sampling; the samples are kept for extl_profiler_dump. */
+void extl_profiler_stop()
+{
+    if(!prof_running)
+        return;
+
+    lua_sethook(l_st, NULL, 0, 0);
+    prof_running=FALSE;
+}
+
+
+/* Write the samples to 'file' in the folded format taken by flame graph
+ * tools: one line per stack, frames separated by ';' root first, and
+ * the time in microseconds. A sample shorter than that still counts as
+ * one microsecond.
+ */
+bool extl_profiler_dump(const char *file)
+{
+    PtrMapIterTmp tmp;
+    ExtlProfStack *ps;
+    bool ret=TRUE;
+    FILE *f;
+    int fd, err;
+    char tmp_file[strlen(file) + 8];
+
+    tmp_file[0] = '\0';
+    strcat(tmp_file, file);
+    strcat(tmp_file, ".XXXXXX");
+    fd = mkstemp(tmp_file);
+    if(fd == -1) {
+        extl_warn_err_obj(tmp_file);
+        return FALSE;
+    }
+
+    f=fdopen(fd, "w");
+
+    if(f==NULL){
+        extl_warn_err_obj(tmp_file);
+        close(fd);
+        unlink(tmp_file);
+        return FALSE;
+    }
+
+    FOR_ALL_ON_PTRMAP(ExtlProfStack*, ps, &prof_stacks, tmp){
+        double us=ps->ns/1000;
+        fprintf(f, "%s %lu\n", stringstore_get(ps->id),
+                (us<1 ? 1UL : (ulong)(us+0.5)));
+    }
+
+    err=ferror(f);
+
+    if(fclose(f)!=0 || err){
+        extl_warn_err_obj(tmp_file);
+        ret=FALSE;
+    }else if(rename(tmp_file, file)!=0){
+        extl_warn_err_obj(file);
+        ret=FALSE;
+    }
+
+    if(!ret)
+        unlink(tmp_file);
+
+    return ret;
+}
+
+
+/*}}}*/
+
+
 /* {{{ lookup global */
 
 /* resolve a chain of table accesses */
@@ -18,6 +18,7 @@
 
 #define EXTL_EXTENSION "lua"
 #define EXTL_COMPILED_EXTENSION "lc"
+#define EXTL_BINARY_EXTENSION "sav"
 #define EXTL_MAX_SERIALISE_DEPTH 128
 
 /* o: userdata/Obj
@@ -88,6 +89,7 @@ extern ExtlFn extl_ref_fn(ExtlFn ref);
 extern ExtlTab extl_ref_table(ExtlTab ref);
 
 extern ExtlTab extl_create_table();
+extern ExtlTab extl_table_copy(ExtlTab ref);
 
 /* Table/get */
 extern bool extl_table_get_vararg(ExtlTab ref, char itype, char type,
@@ -138,6 +140,12 @@ extern bool extl_table_seti_s(ExtlTab ref, int entry, const char *val);
 extern bool extl_table_seti_f(ExtlTab ref, int entry, ExtlFn val);
 extern bool extl_table_seti_t(ExtlTab ref, int entry, ExtlTab val);
 
+/* Table/many */
+
+extern bool extl_table_sets_many(ExtlTab ref, const char *spec, ...);
+extern ExtlTab extl_create_table_with(const char *spec, ...);
+extern uint extl_table_gets_many(ExtlTab ref, const char *spec, ...);
+
 /* Table/clear */
 
 extern bool extl_table_clear_vararg(ExtlTab ref, char itype, va_list *args);
@@ -167,6 +175,8 @@ extern bool extl_call(ExtlFn fnref, const char *spec,
 extern bool extl_loadfile(const char *file, ExtlFn *ret);
 extern bool extl_loadstring(const char *str, ExtlFn *ret);
 extern bool extl_serialize(const char *file, ExtlTab tab);
+extern bool extl_serialize_binary(const char *file, ExtlTab tab);
+extern bool extl_unserialize_binary(const char *file, ExtlTab *ret);
 
 /* Register */
 
@@ -182,6 +192,20 @@ void extl_unregister_class(const char *cls, ExtlExportedFnSpec *fns);
 bool extl_register_module(const char *cls, ExtlExportedFnSpec *fns);
 void extl_unregister_module(const char *cls, ExtlExportedFnSpec *fns);
 
+/* Direct calls */
+
+typedef struct{
+    ExtlExportedFnSpec *spec;
+    int unregister_count;
+    int tabref, nameref;
+} ExtlDirectFn;
+
+bool extl_lookup_direct(const char *tab, const char *name, ExtlDirectFn *ret);
+void extl_free_direct(ExtlDirectFn *fn);
+bool extl_direct_ok(const ExtlDirectFn *fn);
+bool extl_call_direct(const ExtlDirectFn *fn, ExtlL2Param *in,
+                      ExtlL2Param *out);
+
 /* Profiling */
 
 enum ExtlHookEvent {
@@ -195,6 +219,10 @@ typedef void (*ExtlHook) (const enum ExtlHookEvent event, const char *name, cons
 void extl_sethook(ExtlHook hook);
 void extl_resethook();
 
+bool extl_profiler_start(int interval);
+void extl_profiler_stop();
+bool extl_profiler_dump(const char *file);
+
 /* Misc. */
 
 extern bool extl_init();
@@ -80,10 +80,10 @@ typedef Watch ExtlProxy;
 
 #define EXTL_PROXY_OBJ(PROXY) ((PROXY)->obj)
 
-#define EXTL_BEGIN_PROXY_OBJ(PROXY, OBJ)       \
-    watch_init(PROXY);                         \
-    watch_setup(PROXY, OBJ, NULL);             \
-    (OBJ)->flags|=OBJ_EXTL_CACHED;             \
+#define EXTL_BEGIN_PROXY_OBJ(PROXY, OBJ)                \
+    watch_init(PROXY);                                  \
+    watch_setup(PROXY, OBJ, extl_proxy_dest_handler);   \
+    (OBJ)->flags|=OBJ_EXTL_CACHED;                      \
     ((void)0)
 
 #define EXTL_END_PROXY_OBJ(PROXY, OBJ) \
@@ -96,14 +96,6 @@ typedef Watch ExtlProxy;
 
 extern void extl_uncache(Obj *obj);
 
-/*
-static void obj_dest_handler(Watch *watch, Obj *obj)
-{
-    extl_uncache(obj);
-    obj->flags&=~OBJ_EXTL_CACHED;
-}
-*/
-
 /*
  * Miscellaneous.
  */
@@ -276,9 +276,51 @@ static int try_call(const char *file, TryCallParam *param)
 }
 
 
+/* The binary savefile next to the text one is used unless missing or
+ * older than the text file, which may then have been edited by hand.
+ */
+static int try_read_binary(const char *file, TryCallParam *param)
+{
+    size_t len=strlen(file), elen=strlen(EXTL_EXTENSION);
+    struct stat bst, tst;
+    char *bfile=NULL;
+    int ret=EXTL_TRYCONFIG_NOTFOUND;
+
+    if(len<elen || strcmp(file+len-elen, EXTL_EXTENSION)!=0)
+        return ret;
+
+    libtu_asprintf(&bfile, "%.*s" EXTL_BINARY_EXTENSION,
+                   (int)(len-elen), file);
+    if(bfile==NULL)
+        return EXTL_TRYCONFIG_MEMERROR;
+
+    if(stat(bfile, &bst)==0 &&
+       (stat(file, &tst)!=0 || tst.st_mtime<=bst.st_mtime)){
+        if(extl_unserialize_binary(bfile, &(param->tab))){
+            ret=EXTL_TRYCONFIG_OK;
+        }else{
+            param->status=1;
+            ret=EXTL_TRYCONFIG_LOAD_FAILED;
+        }
+    }
+
+    free(bfile);
+
+    return ret;
+}
+
+
 static int try_read_savefile(const char *file, TryCallParam *param)
 {
-    int ret=try_load(file, param);
+    int ret=try_read_binary(file, param);
+
+    if(ret==EXTL_TRYCONFIG_OK || ret==EXTL_TRYCONFIG_MEMERROR)
+        return ret;
+
+    if(ret==EXTL_TRYCONFIG_LOAD_FAILED && access(file, F_OK)!=0)
+        return ret;
+
+    ret=try_load(file, param);
 
     if(ret!=EXTL_TRYCONFIG_OK)
         return ret;
@@ -465,12 +507,7 @@ static bool ensuredir(char *f)
 }
 
 
-/*EXTL_DOC
- * Get a file name to save (session) data in. The string \var{basename}
- * should contain no path or extension components.
- */
-EXTL_EXPORT
-char *extl_get_savefile(const char *basename)
+static char *get_savefile(const char *basename, const char *ext)
 {
     char *res=NULL;
 
@@ -483,27 +520,48 @@ char *extl_get_savefile(const char *basename)
         return NULL;
     }
 
-    libtu_asprintf(&res, "%s/%s." EXTL_EXTENSION, sessiondir, basename);
+    libtu_asprintf(&res, "%s/%s.%s", sessiondir, basename, ext);
 
     return res;
 }
 
 
+/*EXTL_DOC
+ * Get a file name to save (session) data in. The string \var{basename}
+ * should contain no path or extension components.
+ */
+EXTL_EXPORT
+char *extl_get_savefile(const char *basename)
+{
+    return get_savefile(basename, EXTL_EXTENSION);
+}
+
+
 /*EXTL_DOC
  * Write \var{tab} in file with basename \var{basename} in the
- * session directory.
+ * session directory. The table is saved in a binary format, or as Lua
+ * code if that fails; \fnref{extl.read_savefile} reads either.
  */
 EXTL_EXPORT
 bool extl_write_savefile(const char *basename, ExtlTab tab)
 {
     bool ret=FALSE;
-    char *fname=extl_get_savefile(basename);
+    char *fname=get_savefile(basename, EXTL_BINARY_EXTENSION);
 
     if(fname!=NULL){
-        ret=extl_serialize(fname, tab);
+        ret=extl_serialize_binary(fname, tab);
         free(fname);
     }
 
+    if(!ret){
+        fname=extl_get_savefile(basename);
+        if(fname!=NULL){
+            extl_warn(TR("Falling back to %s."), fname);
+            ret=extl_serialize(fname, tab);
+            free(fname);
+        }
+    }
+
     return ret;
 }
 
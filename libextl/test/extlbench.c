@@ -0,0 +1,416 @@
+/*
+ * libextl/test/extlbench.c
+ *
+ * Benchmark suite for the C-Lua boundary: extl_call round trips, calls
+ * to exported functions, table access through references, pushing
+ * object proxies and savefiles. Output is described in
+ * libtu/test/bench.h; allocations made by Lua are counted through the
+ * state's allocator.
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#include "../luaextl.c"
+#include <libtu/misc.h>
+#include "../../libtu/test/bench.h"
+
+#define OPS 200000
+
+
+static lua_Alloc orig_alloc=NULL;
+static void *orig_alloc_ud=NULL;
+
+
+/* Counts each request for memory once, also if the Lua library itself
+ * was linked with the wrapped allocator.
+ */
+static void *counting_alloc(void *UNUSED(ud), void *ptr,
+                            size_t osize, size_t nsize)
+{
+    unsigned long n=bench_allocs;
+    void *p=orig_alloc(orig_alloc_ud, ptr, osize, nsize);
+
+    bench_allocs=n+(nsize>0);
+
+    return p;
+}
+
+
+/*{{{ Calls */
+
+
+static void bench_call()
+{
+    ExtlFn fn_void, fn_i, fn_s;
+    char *s=NULL;
+    int i=0;
+
+    if(!extl_loadstring("return", &fn_void)
+       || !extl_loadstring("local n=... return n+1", &fn_i)
+       || !extl_loadstring("local s=... return s", &fn_s)){
+        fprintf(stderr, "extlbench: loading benchmark code failed\n");
+        exit(1);
+    }
+
+    BENCH("call/void", OPS, extl_call(fn_void, NULL, NULL));
+    BENCH("call/int_int", OPS,
+          extl_call(fn_i, "i", "i", (int)bench_i, &i);
+          bench_sink+=i);
+    BENCH("call/str_str", OPS,
+          extl_call(fn_s, "s", "s", "frame-tiled", &s);
+          free(s));
+
+    extl_unref_fn(fn_void);
+    extl_unref_fn(fn_i);
+    extl_unref_fn(fn_s);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Exported functions */
+
+
+static int bench_export_int(int n)
+{
+    return n+1;
+}
+
+
+static void bench_export_tab(ExtlTab t)
+{
+    bench_sink+=t;
+}
+
+
+static bool bench_l2_i_i(int (*fn)(), ExtlL2Param *in, ExtlL2Param *out)
+{
+    out[0].i=fn(in[0].i);
+    return TRUE;
+}
+
+
+static bool bench_l2_v_t(void (*fn)(), ExtlL2Param *in,
+                         ExtlL2Param *UNUSED(out))
+{
+    fn(in[0].t);
+    return TRUE;
+}
+
+
+static ExtlExportedFnSpec bench_exports[]={
+    {"bench_int", (ExtlExportedFn*)bench_export_int, "i", "i",
+     (ExtlL2CallHandler*)bench_l2_i_i, FALSE, FALSE, FALSE},
+    {"bench_tab", (ExtlExportedFn*)bench_export_tab, "t", NULL,
+     (ExtlL2CallHandler*)bench_l2_v_t, FALSE, FALSE, FALSE},
+    {NULL, NULL, NULL, NULL, NULL, FALSE, FALSE, FALSE}
+};
+
+
+/* Each op makes 100 calls from Lua to C; the int signature takes the
+ * direct path, the table one the protected one.
+ */
+static void bench_export()
+{
+    ExtlFn fn_i, fn_t;
+    ExtlDirectFn direct;
+    ExtlL2Param in[1], out[1];
+
+    if(!extl_register_functions(bench_exports)
+       || !extl_loadstring("for i=1,100 do bench_int(i) end", &fn_i)
+       || !extl_loadstring("local t={} for i=1,100 do bench_tab(t) end",
+                           &fn_t)){
+        fprintf(stderr, "extlbench: setting up exports failed\n");
+        exit(1);
+    }
+
+    BENCH("export/int_int_x100", OPS/100, extl_call(fn_i, NULL, NULL));
+    BENCH("export/tab_void_x100", OPS/100, extl_call(fn_t, NULL, NULL));
+
+    /* The same function called from C without entering Lua, as key
+     * bindings do, including the check that it may still be. */
+    if(extl_lookup_direct(NULL, "bench_int", &direct)){
+        BENCH("export/int_int_direct", OPS,
+              in[0].i=(int)bench_i;
+              if(extl_direct_ok(&direct))
+                  extl_call_direct(&direct, in, out);
+              bench_sink+=out[0].i);
+        extl_free_direct(&direct);
+    }
+
+    extl_unref_fn(fn_i);
+    extl_unref_fn(fn_t);
+    extl_unregister_functions(bench_exports);
+}
+
+
+/*}}}*/
+
+
+/*{{{ LuaJIT FFI */
+
+
+/* An object accessor both as an export and as a plain C function called
+ * through LuaJIT's FFI the way ioncore_ffi.lua does. The latter must be
+ * visible to dlsym, hence not static.
+ */
+
+static int bench_export_flags(Obj *obj)
+{
+    return obj->flags;
+}
+
+
+int extlbench_ffi_obj_flags(Obj *obj)
+{
+    return (obj==NULL ? -1 : obj->flags);
+}
+
+
+static bool bench_l2_i_o(int (*fn)(), ExtlL2Param *in, ExtlL2Param *out)
+{
+    out[0].i=fn(in[0].o);
+    return TRUE;
+}
+
+
+static ExtlExportedFnSpec bench_ffi_exports[]={
+    {"bench_flags", (ExtlExportedFn*)bench_export_flags, "o", "i",
+     (ExtlL2CallHandler*)bench_l2_i_o, FALSE, FALSE, FALSE},
+    {NULL, NULL, NULL, NULL, NULL, FALSE, FALSE, FALSE}
+};
+
+
+static const char bench_ffi_code[]=
+    "local ffi=require('ffi')\n"
+    "ffi.cdef[[\n"
+    "typedef struct { void *obj; } ExtlFfiProxy;\n"
+    "int extlbench_ffi_obj_flags(void *obj);\n"
+    "]]\n"
+    "local C, proxy_t, MAGIC=ffi.C, ffi.typeof('ExtlFfiProxy*'), 0xf00ba7\n"
+    "local function flags(p)\n"
+    "    local mt=type(p)=='userdata' and getmetatable(p)\n"
+    "    if mt and rawget(mt, MAGIC)==MAGIC then\n"
+    "        local o=ffi.cast(proxy_t, p).obj\n"
+    "        if o~=nil then return C.extlbench_ffi_obj_flags(o) end\n"
+    "    end\n"
+    "    return bench_flags(p)\n"
+    "end\n"
+    "return function(o) local s=0 for i=1,100 do s=s+flags(o) end return s end\n";
+
+
+/* Each op reads an object's field 100 times from Lua, as rules and
+ * bindings do with the current region. Only run on LuaJIT.
+ */
+static void bench_ffi()
+{
+    static Obj obj;
+    ExtlFn has_ffi, fn_export, fn_ffi, chunk;
+    bool ok=FALSE;
+    int i=0;
+
+    if(!extl_loadstring("return (pcall(require, 'ffi'))", &has_ffi)
+       || !extl_call(has_ffi, NULL, "b", &ok)){
+        fprintf(stderr, "extlbench: checking for the FFI failed\n");
+        exit(1);
+    }
+
+    extl_unref_fn(has_ffi);
+
+    if(!ok)
+        return;
+
+    OBJ_INIT(&obj, Obj);
+
+    if(!extl_register_functions(bench_ffi_exports)
+       || !extl_loadstring("local o=... local s=0 "
+                           "for i=1,100 do s=s+bench_flags(o) end "
+                           "return s", &fn_export)
+       || !extl_loadstring(bench_ffi_code, &chunk)
+       || !extl_call(chunk, NULL, "f", &fn_ffi)){
+        fprintf(stderr, "extlbench: setting up FFI code failed\n");
+        exit(1);
+    }
+
+    extl_unref_fn(chunk);
+
+    BENCH("ffi/export_x100", OPS/100,
+          extl_call(fn_export, "o", "i", &obj, &i);
+          bench_sink+=i);
+    BENCH("ffi/ffi_x100", OPS/100,
+          extl_call(fn_ffi, "o", "i", &obj, &i);
+          bench_sink+=i);
+
+    extl_unref_fn(fn_export);
+    extl_unref_fn(fn_ffi);
+    extl_unregister_functions(bench_ffi_exports);
+    extl_uncache(&obj);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Tables */
+
+
+static void bench_table()
+{
+    ExtlTab t=extl_create_table();
+    char *s=NULL;
+    int i=0;
+
+    extl_table_sets_s(t, "name", "frame-tiled");
+
+    BENCH("table/create_unref", OPS,
+          extl_unref_table(extl_create_table()));
+    BENCH("table/sets_i", OPS, extl_table_sets_i(t, "x", (int)bench_i));
+    BENCH("table/gets_i", OPS,
+          extl_table_gets_i(t, "x", &i);
+          bench_sink+=i);
+    BENCH("table/seti_i", OPS, extl_table_seti_i(t, 1+bench_i%64, 1));
+    BENCH("table/geti_i", OPS,
+          extl_table_geti_i(t, 1+bench_i%64, &i);
+          bench_sink+=i);
+    BENCH("table/gets_s", OPS,
+          extl_table_gets_s(t, "name", &s);
+          free(s));
+    BENCH("table/get_n", OPS, bench_sink+=extl_table_get_n(t));
+    BENCH("table/sets_many_4", OPS,
+          extl_table_sets_many(t, "iiii", "x", 1, "y", 2, "w", 3, "h", 4));
+    BENCH("table/gets_many_4", OPS,
+          bench_sink+=extl_table_gets_many(t, "iiii", "x", &i, "y", &i,
+                                           "w", &i, "h", &i));
+    BENCH("table/create_with_4", OPS,
+          extl_unref_table(extl_create_table_with("iiii", "x", 1, "y", 2,
+                                                  "w", 3, "h", 4)));
+
+    extl_unref_table(t);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Object proxies */
+
+
+static void bench_obj()
+{
+    static Obj obj;
+
+    OBJ_INIT(&obj, Obj);
+
+    if(!extl_register_class("Obj", NULL, NULL)){
+        fprintf(stderr, "extlbench: registering Obj failed\n");
+        exit(1);
+    }
+
+    BENCH("obj/push_cached", OPS,
+          extl_push_obj(l_st, &obj);
+          lua_pop(l_st, 1));
+    BENCH("obj/push_uncached", OPS,
+          extl_push_obj(l_st, &obj);
+          lua_pop(l_st, 1);
+          extl_uncache(&obj));
+
+    extl_uncache(&obj);
+    extl_unregister_class("Obj", NULL);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Savefiles */
+
+
+static const char bench_layout_code[]=
+    "local function frame(n)\n"
+    "    local t={ type='WFrame', name='frame-'..n, frame_style='frame-tiled',\n"
+    "              geom={ x=0, y=0, w=800, h=600 }, managed={} }\n"
+    "    for i=1,8 do\n"
+    "        t.managed[i]={ type='WClientWin', windowid=4194304+n*8+i,\n"
+    "                       checkcode=i, sizepolicy='full' }\n"
+    "    end\n"
+    "    return t\n"
+    "end\n"
+    "local function split(d, n)\n"
+    "    if d==0 then return { type='WSplitRegion', regparams=frame(n) } end\n"
+    "    return { type='WSplitSplit', dir=(d%2==0 and 'vertical' or 'horizontal'),\n"
+    "             tls=0.5, brs=0.5, tl=split(d-1, n*2), br=split(d-1, n*2+1) }\n"
+    "end\n"
+    "local l={}\n"
+    "for i=1,32 do\n"
+    "    l[i]={ type='WGroupWS', name='ws-'..i, managed={ { type='WTiling',\n"
+    "           bottom=true, split_tree=split(3, i) } } }\n"
+    "end\n"
+    "return { [1]={ managed=l } }\n";
+
+
+/* Saving and restoring a layout of 32 workspaces with 8 frames of 8
+ * clients each, as Lua code and in the binary format.
+ */
+static void bench_savefile()
+{
+    char text[]="/tmp/extlbench-text.XXXXXX";
+    char bin[]="/tmp/extlbench-bin.XXXXXX";
+    ExtlFn fn;
+    ExtlTab tab, t;
+    int fd;
+
+    if((fd=mkstemp(text))==-1 || close(fd)!=0
+       || (fd=mkstemp(bin))==-1 || close(fd)!=0
+       || !extl_loadstring(bench_layout_code, &fn)
+       || !extl_call(fn, NULL, "t", &tab)){
+        fprintf(stderr, "extlbench: setting up savefiles failed\n");
+        exit(1);
+    }
+
+    extl_unref_fn(fn);
+
+    BENCH("savefile/write_text", 50, extl_serialize(text, tab));
+    BENCH("savefile/write_binary", 50, extl_serialize_binary(bin, tab));
+    BENCH("savefile/read_text", 50,
+          extl_loadfile(text, &fn);
+          extl_call(fn, NULL, "t", &t);
+          extl_unref_fn(fn);
+          extl_unref_table(t));
+    BENCH("savefile/read_binary", 50,
+          extl_unserialize_binary(bin, &t);
+          extl_unref_table(t));
+
+    extl_unref_table(tab);
+    unlink(text);
+    unlink(bin);
+}
+
+
+/*}}}*/
+
+
+int main()
+{
+    if(!extl_init()){
+        fprintf(stderr, "extlbench: extl_init failed\n");
+        return 1;
+    }
+
+    orig_alloc=lua_getallocf(l_st, &orig_alloc_ud);
+    lua_setallocf(l_st, counting_alloc, NULL);
+
+    bench_header();
+
+    bench_call();
+    bench_export();
+    bench_ffi();
+    bench_table();
+    bench_obj();
+    bench_savefile();
+
+    extl_deinit();
+
+    return 0;
+}
@@ -44,6 +44,10 @@ int test_tostring()
         return 5;
     }
 
+    free(retstr);
+    errorlog_end(&el);
+    errorlog_deinit(&el);
+
     return 0;
 }
 
@@ -88,9 +92,392 @@ int test_stack_get_bool()
     if (bool_any.value.b != FALSE)
         return 10;
 
+    errorlog_end(&el);
+    errorlog_deinit(&el);
+
+    return 0;
+}
+
+int test_table_many()
+{
+    ExtlTab t, sub, c, csub;
+    char *str=NULL;
+    int x=0, y=0, missing=-1;
+    bool b=FALSE;
+
+    sub=extl_create_table();
+    t=extl_create_table_with("isbst", "x", 1, "name", "frame",
+                             "flag", TRUE, "unset", NULL, "sub", sub);
+    if(t==extl_table_none())
+        return 1;
+
+    if(!extl_table_sets_many(t, "ii", "y", 2, "x", 3))
+        return 2;
+
+    if(extl_table_gets_many(t, "iisbi", "x", &x, "y", &y, "name", &str,
+                            "flag", &b, "unset", &missing)!=0xf)
+        return 3;
+
+    if(x!=3 || y!=2 || b!=TRUE || missing!=-1)
+        return 4;
+
+    if(str==NULL || strcmp(str, "frame")!=0)
+        return 5;
+
+    free(str);
+
+    /* Copies are shallow. */
+    c=extl_table_copy(t);
+    if(c==extl_table_none() || !extl_table_sets_i(c, "x", 4))
+        return 6;
+    if(!extl_table_gets_i(t, "x", &x) || x!=3)
+        return 7;
+    if(!extl_table_gets_t(c, "sub", &csub) || !extl_table_eq(csub, sub))
+        return 8;
+
+    extl_unref_table(csub);
+    extl_unref_table(c);
+    extl_unref_table(sub);
+    extl_unref_table(t);
+
+    return 0;
+}
+
+static int test_export_add(int a, int b)
+{
+    return a+b;
+}
+
+static bool test_l2_i_ii(int (*fn)(), ExtlL2Param *in, ExtlL2Param *out)
+{
+    out[0].i=fn(in[0].i, in[1].i);
+    return TRUE;
+}
+
+static ExtlExportedFnSpec test_exports[]={
+    {"test_add", (ExtlExportedFn*)test_export_add, "ii", "i",
+     (ExtlL2CallHandler*)test_l2_i_ii, FALSE, FALSE, FALSE},
+    {NULL, NULL, NULL, NULL, NULL, FALSE, FALSE, FALSE}
+};
+
+int test_export_call()
+{
+    ExtlFn fn, fn_bad;
+    ErrorLog el;
+    bool b=FALSE, ok, warned;
+    int i=0;
+
+    if(!extl_register_functions(test_exports))
+        return 1;
+
+    if(!extl_loadstring("return test_add(...)", &fn) ||
+       !extl_loadstring("return test_add(1, 'x')==nil", &fn_bad))
+        return 2;
+
+    if(!extl_call(fn, "ii", "i", 2, 3, &i) || i!=5)
+        return 3;
+
+    /* Bad arguments are left to the general handler, which warns
+     * and returns nothing. */
+    errorlog_begin(&el);
+    ok=extl_call(fn_bad, NULL, "b", &b);
+    warned=errorlog_end(&el);
+    errorlog_deinit(&el);
+    if(!ok || !b || !warned)
+        return 4;
+
+    extl_unref_fn(fn);
+    extl_unref_fn(fn_bad);
+    extl_unregister_functions(test_exports);
+
+    return 0;
+}
+
+/* Checks that proxies get the registered metatable, also after the
+ * class has been registered anew.
+ */
+static bool proxy_has_class_metatable(Obj *obj)
+{
+    bool ok;
+
+    extl_push_obj(l_st, obj);
+    if(!lua_getmetatable(l_st, -1)){
+        lua_pop(l_st, 1);
+        return FALSE;
+    }
+    lua_pushstring(l_st, "luaextl_Obj_metatable");
+    lua_gettable(l_st, LUA_REGISTRYINDEX);
+    ok=lua_rawequal(l_st, -1, -2);
+    lua_pop(l_st, 3);
+
+    return ok;
+}
+
+int test_push_obj()
+{
+    static Obj obj;
+    ExtlProxy *first;
+
+    OBJ_INIT(&obj, Obj);
+
+    if(!extl_register_class("Obj", NULL, NULL))
+        return 1;
+
+    if(!proxy_has_class_metatable(&obj))
+        return 2;
+
+    extl_push_obj(l_st, &obj);
+    first=(ExtlProxy*)lua_touserdata(l_st, -1);
+    extl_push_obj(l_st, &obj);
+    if(lua_touserdata(l_st, -1)!=first)
+        return 3;
+    lua_pop(l_st, 2);
+
+    extl_uncache(&obj);
+    if(!proxy_has_class_metatable(&obj))
+        return 4;
+
+    extl_uncache(&obj);
+    extl_unregister_class("Obj", NULL);
+    if(!extl_register_class("Obj", NULL, NULL))
+        return 5;
+    if(!proxy_has_class_metatable(&obj))
+        return 6;
+
+    extl_uncache(&obj);
+
+    return 0;
+}
+
+int test_proxy_ref()
+{
+    Obj *obj=ALLOC(Obj);
+    ExtlProxy *proxy;
+    int ref;
+
+    if(obj==NULL)
+        return 1;
+
+    OBJ_INIT(obj, Obj);
+
+    extl_push_obj(l_st, obj);
+    proxy=(ExtlProxy*)lua_touserdata(l_st, -1);
+    ref=obj->obj_extl_ref;
+    if(proxy==NULL || ref==0)
+        return 2;
+
+    lua_rawgeti(l_st, LUA_REGISTRYINDEX, ref);
+    if(lua_touserdata(l_st, -1)!=proxy)
+        return 3;
+    lua_pop(l_st, 1);
+
+    /* Destroying the object must invalidate the proxy and release
+     * the reference. */
+    destroy_obj(obj);
+    if(EXTL_PROXY_OBJ(proxy)!=NULL)
+        return 4;
+
+    lua_rawgeti(l_st, LUA_REGISTRYINDEX, ref);
+    if(lua_touserdata(l_st, -1)==proxy)
+        return 5;
+    lua_pop(l_st, 2);
+
     return 0;
 }
 
+/* Replacing an exported function from Lua must be honoured. */
+static const char overridestr[]=
+    "saved_test_add=test_add\n"
+    "test_add=function(a, b) return 0 end\n";
+
+static const char restorestr[]=
+    "test_add=saved_test_add\n"
+    "saved_test_add=nil\n";
+
+static bool run_string(const char *str)
+{
+    ExtlFn fn;
+    bool ret;
+
+    if(!extl_loadstring(str, &fn))
+        return FALSE;
+
+    ret=extl_call(fn, NULL, NULL);
+    extl_unref_fn(fn);
+
+    return ret;
+}
+
+int test_direct_call()
+{
+    ExtlDirectFn fn, fn2;
+    ExtlL2Param in[2], out[1];
+
+    if(!extl_register_functions(test_exports))
+        return 1;
+
+    if(!extl_lookup_direct(NULL, "test_add", &fn) || !extl_direct_ok(&fn))
+        return 2;
+
+    in[0].i=2;
+    in[1].i=3;
+    if(!extl_call_direct(&fn, in, out) || out[0].i!=5)
+        return 3;
+
+    if(extl_lookup_direct("string", "format", &fn2) ||
+       extl_lookup_direct(NULL, "no_such_function", &fn2))
+        return 4;
+
+    if(!run_string(overridestr) || extl_direct_ok(&fn))
+        return 6;
+
+    if(!run_string(restorestr) || !extl_direct_ok(&fn))
+        return 7;
+
+    extl_unregister_functions(test_exports);
+
+    if(extl_direct_ok(&fn))
+        return 5;
+
+    extl_free_direct(&fn);
+
+    return 0;
+}
+
+static const char profilestr[]=
+    "if jit then jit.off() end\n"
+    "local function busy(n)\n"
+    "    local s=0\n"
+    "    for i=1,n do s=s+i%7 end\n"
+    "    return s\n"
+    "end\n"
+    "local s=busy(200000)\n"
+    "profile_co=coroutine.create(function()\n"
+    "    coroutine.yield()\n"
+    "    busy(1000)\n"
+    "    return debug.gethook()==nil\n"
+    "end)\n"
+    "coroutine.resume(profile_co)\n"
+    "return s\n";
+
+/* The coroutine was created while profiling; it must not keep sampling. */
+static const char profilecostr[]=
+    "local _, unhooked=coroutine.resume(profile_co)\n"
+    "profile_co=nil\n"
+    "return unhooked\n";
+
+int test_profiler()
+{
+    char file[]="/tmp/extltest-profile.XXXXXX";
+    char line[512];
+    ExtlFn fn;
+    FILE *f;
+    int fd, n=0, found=0;
+    bool unhooked=FALSE;
+    unsigned long us;
+
+    fd=mkstemp(file);
+    if(fd==-1)
+        return 1;
+    close(fd);
+
+    if(!extl_loadstring(profilestr, &fn))
+        return 2;
+
+    if(!extl_profiler_start(100))
+        return 3;
+    if(!extl_call(fn, NULL, "i", &n))
+        return 4;
+    extl_profiler_stop();
+    extl_unref_fn(fn);
+
+    if(lua_gethook(l_st)!=NULL)
+        return 5;
+
+    if(!extl_loadstring(profilecostr, &fn))
+        return 2;
+    if(!extl_call(fn, NULL, "b", &unhooked) || !unhooked)
+        return 9;
+    extl_unref_fn(fn);
+
+    if(!extl_profiler_dump(file))
+        return 6;
+
+    f=fopen(file, "r");
+    if(f==NULL)
+        return 7;
+
+    /* Folded stacks: root first, the sampled function last. */
+    while(fgets(line, sizeof(line), f)!=NULL){
+        char *sp=strrchr(line, ' ');
+        if(sp==NULL || sscanf(sp, " %lu", &us)!=1 || us==0)
+            break;
+        *sp='\0';
+        if(strncmp(line, "main@", 5)==0 && strstr(line, ";busy@")!=NULL)
+            found++;
+    }
+
+    fclose(f);
+    unlink(file);
+
+    return (found ? 0 : 8);
+}
+
+static const char savefilestr[]=
+    "local t={ name=\"a\\0b\", n=3, x=-1.5, big=-4294967296, ok=true, no=false,\n"
+    "          list={ 1, 2, { nested={ 'deep' } } }, [2.5]='f', [7]=7 }\n"
+    "local function eq(a, b)\n"
+    "    if type(a)~=type(b) then return false end\n"
+    "    if type(a)~='table' then return a==b end\n"
+    "    for k, v in pairs(a) do if not eq(v, b[k]) then return false end end\n"
+    "    for k, v in pairs(b) do if a[k]==nil then return false end end\n"
+    "    return true\n"
+    "end\n"
+    "return t, function(u) return eq(t, u) end\n";
+
+
+int test_savefile_binary()
+{
+    char file[]="/tmp/extltest-savefile.XXXXXX";
+    ExtlFn fn, eq;
+    ExtlTab t, u;
+    bool ok=FALSE;
+    int fd;
+
+    fd=mkstemp(file);
+    if(fd==-1)
+        return 1;
+    close(fd);
+
+    if(!extl_loadstring(savefilestr, &fn))
+        return 2;
+    if(!extl_call(fn, NULL, "tf", &t, &eq))
+        return 3;
+    extl_unref_fn(fn);
+
+    if(!extl_serialize_binary(file, t))
+        return 4;
+    if(!extl_unserialize_binary(file, &u))
+        return 5;
+    if(!extl_call(eq, "t", "b", u, &ok) || !ok)
+        return 6;
+
+    extl_unref_table(u);
+    extl_unref_table(t);
+    extl_unref_fn(eq);
+
+    /* Damaged files must be rejected. */
+    if(truncate(file, 30)!=0)
+        return 7;
+    if(extl_unserialize_binary(file, &u))
+        return 8;
+
+    unlink(file);
+
+    return 0;
+}
+
+
 int main()
 {
     fprintf(stdout, "[TESTING] libextl ====\n");
@@ -118,6 +505,69 @@ int main()
         fprintf(stdout, "[OK]\n");
     }
 
+    fprintf(stdout, "[TEST] test_table_many: ");
+    result = test_table_many();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_export_call: ");
+    result = test_export_call();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_push_obj: ");
+    result = test_push_obj();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_proxy_ref: ");
+    result = test_proxy_ref();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_direct_call: ");
+    result = test_direct_call();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_profiler: ");
+    result = test_profiler();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_savefile_binary: ");
+    result = test_savefile_binary();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
     extl_deinit();
 
     return err;
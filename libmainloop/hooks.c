@@ -111,22 +111,53 @@ WHook *mainloop_get_hook(const char *name)
 /*{{{ Init/deinit */
 
 
+/* The hook keeps count of its C and Lua functions, so that callers can
+ * skip preparing for Lua calls (or the call altogether) when there is
+ * nobody to call.
+ */
+
+
+static void free_keys(WHook *hk, WHookItem *item)
+{
+    int i;
+
+    if(item->keys==NULL)
+        return;
+
+    if(hk->keyfreefn!=NULL){
+        for(i=0; i<item->nkeys; i++)
+            hk->keyfreefn(item->keys[i]);
+    }
+
+    free(item->keys);
+    item->keys=NULL;
+    item->nkeys=0;
+}
+
+
 static void destroy_item(WHook *hk, WHookItem *item)
 {
-    if(item->fn==NULL)
+    if(item->fn==NULL){
         extl_unref_fn(item->efn);
+        free_keys(hk, item);
+        hk->nefn--;
+    }else{
+        hk->nfn--;
+    }
     UNLINK_ITEM(hk->items, item, next, prev);
-    free(item);
+    SLAB_FREE(WHookItem, item);
 }
 
 
 static WHookItem *create_item(WHook *hk)
 {
-    WHookItem *item=ALLOC(WHookItem);
+    WHookItem *item=SLAB_ALLOC(WHookItem);
     if(item!=NULL){
         LINK_ITEM_FIRST(hk->items, item, next, prev);
         item->fn=NULL;
         item->efn=extl_fn_none();
+        item->keys=NULL;
+        item->nkeys=0;
     }
 
     return item;
@@ -136,6 +167,10 @@ static WHookItem *create_item(WHook *hk)
 bool hook_init(WHook *hk)
 {
     hk->items=NULL;
+    hk->nfn=0;
+    hk->nefn=0;
+    hk->keyfn=NULL;
+    hk->keyfreefn=NULL;
     return TRUE;
 }
 
@@ -208,6 +243,7 @@ bool hook_add(WHook *hk, WHookDummy *fn)
     if(item==NULL)
         return FALSE;
     item->fn=fn;
+    hk->nfn++;
     return TRUE;
 }
 
@@ -235,6 +271,78 @@ bool hook_add_extl(WHook *hk, ExtlFn efn)
         return FALSE;
 
     item->efn=extl_ref_fn(efn);
+    hk->nefn++;
+
+    return TRUE;
+}
+
+
+/* Sets the function used to convert the names given to
+ * hook_add_filtered_extl to the keys passed to hook_call_key, and the
+ * one to free such keys, if any. Keys are compared as pointers.
+ */
+void hook_set_keyfn(WHook *hk, WHookKeyFn *keyfn, WHookKeyFreeFn *keyfreefn)
+{
+    hk->keyfn=keyfn;
+    hk->keyfreefn=keyfreefn;
+}
+
+
+/*EXTL_DOC
+ * Like \fnref{WHook.add}, but \var{efn} is only called when the hook
+ * is triggered for one of the \var{names} listed. For
+ * \code{region_notify_hook} these are notification types such as
+ * \code{"activated"}, and for \code{clientwin_property_change_hook}
+ * property names such as \code{"_NET_WM_NAME"}. The check is done
+ * without calling Lua. Names the hook is never triggered with are
+ * reported and ignored, and \var{efn} is not added if none remain.
+ * Hooks that are not triggered with such names do not support
+ * filtering.
+ */
+EXTL_EXPORT_AS(WHook, add_filtered)
+bool hook_add_filtered_extl(WHook *hk, ExtlFn efn, ExtlTab names)
+{
+    WHookItem *item;
+    char *name;
+    void *key;
+    int i, n;
+
+    if(hk->keyfn==NULL){
+        warn(TR("This hook does not support filtering."));
+        return FALSE;
+    }
+
+    if(!hook_add_extl(hk, efn))
+        return FALSE;
+
+    item=hook_find_extl(hk, efn);
+    assert(item!=NULL);
+
+    n=extl_table_get_n(names);
+
+    if(n>0){
+        item->keys=ALLOC_N(void*, n);
+        if(item->keys==NULL){
+            destroy_item(hk, item);
+            return FALSE;
+        }
+    }
+
+    for(i=1; i<=n; i++){
+        if(!extl_table_geti_s(names, i, &name))
+            continue;
+        key=hk->keyfn(name);
+        if(key==NULL)
+            warn(TR("Invalid hook filter \"%s\"."), name);
+        else
+            item->keys[item->nkeys++]=key;
+        free(name);
+    }
+
+    if(item->nkeys==0){
+        destroy_item(hk, item);
+        return FALSE;
+    }
 
     return TRUE;
 }
@@ -343,21 +451,56 @@ static bool marshall_alt_p(bool (*fn)(), void *param)
 /*{{{ Call */
 
 
-void hook_call(const WHook *hk, void *p,
-               WHookMarshall *m, WHookMarshallExtl *em)
+static bool item_wants(const WHookItem *hi, void *key)
+{
+    int i;
+
+    if(hi->keys==NULL || key==NULL)
+        return TRUE;
+
+    for(i=0; i<hi->nkeys; i++){
+        if(hi->keys[i]==key)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+/* Calls the functions on hk, skipping Lua functions added with filters
+ * that do not include key. A NULL key matches all.
+ */
+void hook_call_key(const WHook *hk, void *p, void *key,
+                   WHookMarshall *m, WHookMarshallExtl *em)
 {
     WHookItem *hi, *next;
 
+    if(hk->nefn==0 || em==NULL){
+        for(hi=hk->items; hi!=NULL; hi=next){
+            next=hi->next;
+            if(hi->fn!=NULL)
+                m(hi->fn, p);
+        }
+        return;
+    }
+
     for(hi=hk->items; hi!=NULL; hi=next){
         next=hi->next;
         if(hi->fn!=NULL)
             m(hi->fn, p);
-        else if(em!=NULL)
+        else if(item_wants(hi, key))
             em(hi->efn, p);
     }
 }
 
 
+void hook_call(const WHook *hk, void *p,
+               WHookMarshall *m, WHookMarshallExtl *em)
+{
+    hook_call_key(hk, p, NULL, m, em);
+}
+
+
 bool hook_call_alt(const WHook *hk, void *p,
                    WHookMarshall *m, WHookMarshallExtl *em)
 {
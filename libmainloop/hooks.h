@@ -18,18 +18,29 @@ INTRCLASS(WHook);
 typedef void WHookDummy();
 typedef bool WHookMarshall(WHookDummy *fn, void *param);
 typedef bool WHookMarshallExtl(ExtlFn fn, void *param);
+typedef void *WHookKeyFn(const char *name);
+typedef void WHookKeyFreeFn(void *key);
 
 DECLSTRUCT(WHookItem){
     WHookDummy *fn;
     ExtlFn efn;
+    void **keys;
+    int nkeys;
     WHookItem *next, *prev;
 };
 
 DECLCLASS(WHook){
     Obj obj;
     WHookItem *items;
+    int nfn;
+    int nefn;
+    WHookKeyFn *keyfn;
+    WHookKeyFreeFn *keyfreefn;
 };
 
+#define HOOK_IS_EMPTY(HK) ((HK)->items==NULL)
+#define HOOK_HAS_EXTL(HK) ((HK)->nefn>0)
+
 
 /* If hk==NULL to register, new is attempted to be created. */
 extern WHook *mainloop_register_hook(const char *name, WHook *hk);
@@ -48,8 +59,14 @@ extern bool hook_add_extl(WHook *hk, ExtlFn fn);
 extern bool hook_remove_extl(WHook *hk, ExtlFn fn);
 extern WHookItem *hook_find_extl(WHook *hk, ExtlFn efn);
 
+extern void hook_set_keyfn(WHook *hk, WHookKeyFn *keyfn,
+                           WHookKeyFreeFn *keyfreefn);
+extern bool hook_add_filtered_extl(WHook *hk, ExtlFn fn, ExtlTab names);
+
 extern void hook_call(const WHook *hk, void *p,
                       WHookMarshall *m, WHookMarshallExtl *em);
+extern void hook_call_key(const WHook *hk, void *p, void *key,
+                          WHookMarshall *m, WHookMarshallExtl *em);
 extern void hook_call_v(const WHook *hk);
 extern void hook_call_o(const WHook *hk, Obj *o);
 extern void hook_call_p(const WHook *hk, void *p, WHookMarshallExtl *em);
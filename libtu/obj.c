@@ -14,9 +14,10 @@
 #include "objp.h"
 #include "misc.h"
 #include "dlist.h"
+#include "slab.h"
 
 
-ClassDescr CLASSDESCR(Obj)={"Obj", NULL, 0, NULL, NULL};
+ClassDescr CLASSDESCR(Obj)={"Obj", NULL, 0, NULL, NULL, NULL, 0, NULL, 0};
 
 
 static void do_watches(Obj *obj, bool call);
@@ -48,67 +49,182 @@ void destroy_obj(Obj *obj)
 
     do_watches(obj, FALSE);
 
-    free(obj);
+    if(obj->flags&OBJ_SLAB)
+        slab_free(obj);
+    else
+        free(obj);
 }
 
 
 /*}}}*/
 
 
-/*{{{ is/cast */
+/*{{{ Class displays */
 
 
-bool obj_is(const Obj *obj, const ClassDescr *descr)
+/* Each class gets a display: the array of its ancestors indexed by
+ * depth. Then 'obj' is a 'descr' iff descr->depth<=obj's depth and the
+ * display of obj's class has descr at that depth. Building a display
+ * also enters the class in a name hash for obj_is_str. The hash keeps
+ * copies of names and never dereferences the class descriptors, as
+ * those of unloaded modules may be gone.
+ */
+
+INTRSTRUCT(ClassName);
+
+DECLSTRUCT(ClassName){
+    char *name;
+    ClassDescr *descr;
+    int depth;
+    ClassName *next;
+};
+
+#define CLASSNAME_HASH_SIZE 128
+
+static ClassName *classname_hash[CLASSNAME_HASH_SIZE];
+
+
+static uint hash_name(const char *str)
 {
-    ClassDescr *d;
+    uint h=0;
 
-    if(obj==NULL)
+    while(*str!='\0')
+        h=h*31+(uchar)*str++;
+
+    return h%CLASSNAME_HASH_SIZE;
+}
+
+
+static void register_class_name(ClassDescr *descr)
+{
+    ClassName *cn=ALLOC(ClassName);
+    uint h;
+
+    if(cn==NULL)
+        return;
+
+    cn->name=scopy(descr->name);
+
+    if(cn->name==NULL){
+        free(cn);
+        return;
+    }
+
+    h=hash_name(descr->name);
+    cn->descr=descr;
+    cn->depth=descr->depth;
+    cn->next=classname_hash[h];
+    classname_hash[h]=cn;
+}
+
+
+static bool ensure_display(ClassDescr *descr)
+{
+    ClassDescr **display;
+    int depth=0;
+
+    if(descr->display!=NULL)
+        return TRUE;
+
+    if(descr->ancestor!=NULL){
+        if(!ensure_display(descr->ancestor))
+            return FALSE;
+        depth=descr->ancestor->depth+1;
+    }
+
+    display=ALLOC_N(ClassDescr*, depth+1);
+
+    if(display==NULL)
         return FALSE;
 
-    d=obj->obj_type;
+    if(depth>0)
+        memcpy(display, descr->ancestor->display, depth*sizeof(ClassDescr*));
+    display[depth]=descr;
 
-    while(d!=NULL){
-        if(d==descr)
-            return TRUE;
-        d=d->ancestor;
+    descr->depth=depth;
+    descr->display=display;
+
+    register_class_name(descr);
+
+    return TRUE;
+}
+
+
+#define DISPLAY_HAS(D, DESCR) \
+    ((DESCR)->depth<=(D)->depth && (D)->display[(DESCR)->depth]==(DESCR))
+
+
+static bool is_subclass(ClassDescr *d, ClassDescr *descr)
+{
+    if(d->display!=NULL && descr->display!=NULL)
+        return DISPLAY_HAS(d, descr);
+
+    if(!ensure_display(d) || !ensure_display(descr)){
+        while(d!=NULL){
+            if(d==descr)
+                return TRUE;
+            d=d->ancestor;
+        }
+        return FALSE;
     }
-    return FALSE;
+
+    return DISPLAY_HAS(d, descr);
+}
+
+
+/*}}}*/
+
+
+/*{{{ is/cast */
+
+
+bool obj_is(const Obj *obj, const ClassDescr *descr)
+{
+    if(obj==NULL)
+        return FALSE;
+
+    return is_subclass(obj->obj_type, (ClassDescr*)descr);
 }
 
 
 bool obj_is_str(const Obj *obj, const char *str)
 {
     ClassDescr *d;
+    ClassName *cn;
 
     if(obj==NULL || str==NULL)
         return FALSE;
 
     d=obj->obj_type;
 
-    while(d!=NULL){
-        if(strcmp(d->name, str)==0)
+    if(!ensure_display(d)){
+        while(d!=NULL){
+            if(strcmp(d->name, str)==0)
+                return TRUE;
+            d=d->ancestor;
+        }
+        return FALSE;
+    }
+
+    for(cn=classname_hash[hash_name(str)]; cn!=NULL; cn=cn->next){
+        if(cn->depth<=d->depth && d->display[cn->depth]==cn->descr
+           && strcmp(cn->name, str)==0){
             return TRUE;
-        d=d->ancestor;
+        }
     }
+
     return FALSE;
 }
 
 
 const void *obj_cast(const Obj *obj, const ClassDescr *descr)
 {
-    ClassDescr *d;
-
     if(obj==NULL)
         return NULL;
 
-    d=obj->obj_type;
-
-    while(d!=NULL){
-        if(d==descr)
-            return (void*)obj;
-        d=d->ancestor;
-    }
-    return NULL;
+    return (is_subclass(obj->obj_type, (ClassDescr*)descr)
+            ? (void*)obj
+            : NULL);
 }
 
 
@@ -206,6 +322,131 @@ DynFun *lookup_dynfun(const Obj *obj, DynFun *func,
 }
 
 
+/* Dynfuns are given dense slot numbers on first call, and each class
+ * has a table of handlers indexed by slot. A table entry is resolved with
+ * lookup_dynfun the first time the dynfun is called on an object of that
+ * class; after that the call is an indexed load. Unresolved entries are
+ * NULL and entries for dynfuns the class does not implement are
+ * dummy_dyn.
+ */
+
+static DynFun **dynfun_slots=NULL;
+static int dynfun_slots_n=0;
+static ClassDescr **dispatch_classes=NULL;
+static int dispatch_classes_n=0;
+
+
+static int get_dynfun_slot(DynFun *func)
+{
+    DynFun **tmp;
+    int i;
+
+    for(i=0; i<dynfun_slots_n; i++){
+        if(dynfun_slots[i]==func)
+            return i;
+    }
+
+    tmp=REALLOC_N(dynfun_slots, DynFun*, dynfun_slots_n, dynfun_slots_n+1);
+    if(tmp==NULL)
+        return -1;
+
+    dynfun_slots=tmp;
+    dynfun_slots[dynfun_slots_n]=func;
+
+    return dynfun_slots_n++;
+}
+
+
+static DynFun *fill_dispatch(const Obj *obj, DynFun *func, int slot,
+                             bool *funnotfound)
+{
+    ClassDescr *descr=obj->obj_type;
+    DynFun *handler=lookup_dynfun(obj, func, funnotfound);
+
+    if(slot>=descr->dispatch_n){
+        DynFun **tmp;
+
+        if(descr->dispatch==NULL){
+            /* Remember the class so that the table can be flushed. */
+            ClassDescr **ctmp=REALLOC_N(dispatch_classes, ClassDescr*,
+                                        dispatch_classes_n,
+                                        dispatch_classes_n+1);
+            if(ctmp==NULL)
+                return handler;
+            dispatch_classes=ctmp;
+            dispatch_classes[dispatch_classes_n++]=descr;
+        }
+
+        tmp=REALLOC_N(descr->dispatch, DynFun*,
+                      descr->dispatch_n, dynfun_slots_n);
+        if(tmp==NULL)
+            return handler;
+        descr->dispatch=tmp;
+        descr->dispatch_n=dynfun_slots_n;
+    }
+
+    descr->dispatch[slot]=(*funnotfound ? (DynFun*)dummy_dyn : handler);
+
+    return handler;
+}
+
+
+DynFun *lookup_dynfun_slot(const Obj *obj, DynFun *func,
+                           int *slot, bool *funnotfound)
+{
+    ClassDescr *descr;
+    DynFun *handler;
+
+    if(obj==NULL)
+        return NULL;
+
+    if(*slot<0){
+        *slot=get_dynfun_slot(func);
+        if(*slot<0)
+            return lookup_dynfun(obj, func, funnotfound);
+    }
+
+    descr=obj->obj_type;
+
+    if(*slot<descr->dispatch_n){
+        handler=descr->dispatch[*slot];
+        if(handler!=NULL){
+            *funnotfound=(handler==(DynFun*)dummy_dyn);
+            return handler;
+        }
+    }
+
+    return fill_dispatch(obj, func, *slot, funnotfound);
+}
+
+
+/* Drop all dispatch tables and retire all slots. This must be called
+ * when classes or dynfuns may go away (module unloading), while the
+ * class descriptors are still valid. Call sites keep their slot numbers,
+ * but slots are never handed out again, so a function loaded later at
+ * the address of a retired one gets a fresh slot. Surviving call sites
+ * simply refill their entries on the next call.
+ */
+void flush_dynfun_dispatch()
+{
+    int i;
+
+    for(i=0; i<dispatch_classes_n; i++){
+        ClassDescr *descr=dispatch_classes[i];
+        free(descr->dispatch);
+        descr->dispatch=NULL;
+        descr->dispatch_n=0;
+    }
+
+    free(dispatch_classes);
+    dispatch_classes=NULL;
+    dispatch_classes_n=0;
+
+    for(i=0; i<dynfun_slots_n; i++)
+        dynfun_slots[i]=NULL;
+}
+
+
 bool has_dynfun(const Obj *obj, DynFun *func)
 {
     bool funnotfound;
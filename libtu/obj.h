@@ -39,11 +39,15 @@ DECLCLASS(Obj){
     ClassDescr *obj_type;
     Watch *obj_watches;
     int flags;
+    /* Reference to the scripting proxy of the object, maintained by
+     * libextl; 0 if there is none. */
+    int obj_extl_ref;
 };
 
 #define OBJ_DEST 0x0001
 #define OBJ_EXTL_CACHED 0x0002
 #define OBJ_EXTL_OWNED 0x0004
+#define OBJ_SLAB 0x0008
 
 #define OBJ_IS_BEING_DESTROYED(OBJ) (((Obj*)(OBJ))->flags&OBJ_DEST)
 
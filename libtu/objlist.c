@@ -12,6 +12,7 @@
 #include "objlist.h"
 #include "dlist.h"
 #include "misc.h"
+#include "slab.h"
 
 
 static ObjList *reuse_first(ObjList **objlist)
@@ -36,7 +37,7 @@ static ObjList *reuse(ObjList **objlist)
         return last;
     }else{
         if(last!=NULL)
-            free(last);
+            SLAB_FREE(ObjList, last);
         return first;
     }
 }
@@ -48,9 +49,9 @@ static void optimise(ObjList **objlist)
     ObjList *last=reuse_first(objlist);
 
     if(first!=NULL)
-        free(first);
+        SLAB_FREE(ObjList, first);
     if(last!=NULL)
-        free(last);
+        SLAB_FREE(ObjList, last);
 }
 
 
@@ -68,7 +69,7 @@ void watch_handler(Watch *watch, Obj *UNUSED(obj))
         ObjList *tmp=node->prev;
         node->next->prev=node->prev;
         tmp->next=node->next;
-        free(node);
+        SLAB_FREE(ObjList, node);
     }
 }
 
@@ -77,7 +78,7 @@ static void free_node(ObjList **objlist, ObjList *node)
 {
     watch_reset(&(node->watch));
     UNLINK_ITEM(*objlist, node, next, prev);
-    free(node);
+    SLAB_FREE(ObjList, node);
 }
 
 
@@ -88,7 +89,7 @@ static ObjList *mknode(void *obj)
     if(obj==NULL)
         return NULL;
 
-    node=ALLOC(ObjList);
+    node=SLAB_ALLOC(ObjList);
 
     if(node==NULL)
         return FALSE;
@@ -96,7 +97,7 @@ static ObjList *mknode(void *obj)
     watch_init(&(node->watch));
 
     if(!watch_setup(&(node->watch), obj, watch_handler)){
-        free(node);
+        SLAB_FREE(ObjList, node);
         return NULL;
     }
 
@@ -12,6 +12,7 @@
 
 #include "types.h"
 #include "obj.h"
+#include "slab.h"
 
 typedef void DynFun();
 
@@ -27,26 +28,41 @@ DECLSTRUCT(ClassDescr){
     int funtab_n;
     DynFunTab *funtab;
     void (*destroy_fn)();
+    /* Flattened dispatch table indexed by dynfun slot; filled lazily. */
+    DynFun **dispatch;
+    int dispatch_n;
+    /* Ancestors indexed by depth, Obj first; built on first use. */
+    ClassDescr **display;
+    int depth;
 };
 
 #define OBJ_TYPESTR(OBJ) ((OBJ) ? ((Obj*)OBJ)->obj_type->name : NULL)
 
 #define IMPLCLASS(CLS, ANCESTOR, DFN, DYN)                         \
         ClassDescr CLASSDESCR(CLS)={                              \
-            #CLS, &CLASSDESCR(ANCESTOR), -1, DYN, (void (*)())DFN}
+            #CLS, &CLASSDESCR(ANCESTOR), -1, DYN, (void (*)())DFN, \
+            NULL, 0, NULL, 0}
 
 #define OBJ_INIT(O, TYPE) {((Obj*)(O))->obj_type=&CLASSDESCR(TYPE); \
-    ((Obj*)(O))->obj_watches=NULL; ((Obj*)(O))->flags=0;}
+    ((Obj*)(O))->obj_watches=NULL; ((Obj*)(O))->flags=0; \
+    ((Obj*)(O))->obj_extl_ref=0;}
+
+/* Objects are allocated from the slab allocator when small enough;
+ * OBJ_SLAB tells destroy_obj how to free them.
+ */
+#define OBJ_ALLOC_IMPL(OBJ)                                        \
+    OBJ *p;  p=SLAB_ALLOC(OBJ); if(p==NULL){ warn_err(); return NULL; } \
+    OBJ_INIT(p, OBJ);                                              \
+    if(sizeof(OBJ)<=SLAB_MAX_SIZE) ((Obj*)p)->flags|=OBJ_SLAB;     \
+    ((void)0)
 
 #define CREATEOBJ_IMPL(OBJ, LOWOBJ, INIT_ARGS)                     \
-    OBJ *p;  p=ALLOC(OBJ); if(p==NULL){ warn_err(); return NULL; } \
-    OBJ_INIT(p, OBJ);                                             \
-    if(!LOWOBJ ## _init INIT_ARGS) { free((void*)p); return NULL; } return p; \
+    OBJ_ALLOC_IMPL(OBJ);                                           \
+    if(!LOWOBJ ## _init INIT_ARGS) { SLAB_FREE(OBJ, p); return NULL; } return p; \
     ((void)0)
 
 #define SIMPLECREATEOBJ_IMPL(OBJ, LOWOBJ)                          \
-    OBJ *p;  p=ALLOC(OBJ); if(p==NULL){ warn_err(); return NULL; } \
-    OBJ_INIT(p, OBJ);                                              \
+    OBJ_ALLOC_IMPL(OBJ);                                           \
     return p;                                                      \
     ((void)0)
 
@@ -54,19 +70,29 @@ DECLSTRUCT(ClassDescr){
 
 extern DynFun *lookup_dynfun(const Obj *obj, DynFun *func,
                              bool *funnotfound);
+extern DynFun *lookup_dynfun_slot(const Obj *obj, DynFun *func,
+                                  int *slot, bool *funnotfound);
 extern bool has_dynfun(const Obj *obj, DynFun *func);
+extern void flush_dynfun_dispatch();
+
+/* Each call site caches the slot of the dynfun in 'dynslot'. */
 
 #define CALL_DYN(FUNC, OBJ, ARGS)                                \
+    static int dynslot=-1;                                       \
     bool funnotfound;                                            \
-    lookup_dynfun((Obj*)OBJ, (DynFun*)FUNC, &funnotfound) ARGS;  \
+    lookup_dynfun_slot((Obj*)OBJ, (DynFun*)FUNC, &dynslot,       \
+                       &funnotfound) ARGS;                       \
     ((void)0)
 
 #define CALL_DYN_RET(RETV, RET, FUNC, OBJ, ARGS)                 \
     typedef RET ThisDynFun();                                    \
+    static int dynslot=-1;                                       \
     bool funnotfound;                                            \
     ThisDynFun *funtmp;                                          \
-    funtmp=(ThisDynFun*)lookup_dynfun((Obj*)OBJ, (DynFun*)FUNC,  \
-                                      &funnotfound);             \
+    funtmp=(ThisDynFun*)lookup_dynfun_slot((Obj*)OBJ,            \
+                                           (DynFun*)FUNC,        \
+                                           &dynslot,             \
+                                           &funnotfound);        \
     if(!funnotfound){                                            \
         RETV=funtmp ARGS;                                        \
     } ((void)0)
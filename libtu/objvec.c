@@ -0,0 +1,279 @@
+/*
+ * libtu/objvec.c
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#include <stdlib.h>
+
+#include "types.h"
+#include "misc.h"
+#include "obj.h"
+#include "objvec.h"
+
+
+/* The watch of each element belongs to its PtrVec slot. Watches are
+ * linked into the watched object, so they must not move; they are
+ * allocated in fixed chunks indexed by slot number.
+ */
+
+#define WATCH_CHUNK 32
+
+
+/*{{{ Watches */
+
+
+DECLSTRUCT(ObjVecWatch){
+    Watch watch; /* Must be kept at head of structure */
+    ObjVec *ov;
+    uint slot;
+};
+
+
+static ObjVecWatch *watch_of(const ObjVec *ov, uint slot)
+{
+    return &ov->watches[slot/WATCH_CHUNK][slot%WATCH_CHUNK];
+}
+
+
+static bool ensure_watch(ObjVec *ov, uint slot)
+{
+    uint n=slot/WATCH_CHUNK+1;
+
+    if(n>ov->nchunks){
+        ObjVecWatch **w=REALLOC_N(ov->watches, ObjVecWatch*,
+                                  ov->nchunks, n);
+        if(w==NULL)
+            return FALSE;
+        ov->watches=w;
+        ov->nchunks=n;
+    }
+
+    if(ov->watches[n-1]==NULL){
+        ov->watches[n-1]=ALLOC_N(ObjVecWatch, WATCH_CHUNK);
+        if(ov->watches[n-1]==NULL)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+static void watch_handler(Watch *watch, Obj *UNUSED(obj))
+{
+    ObjVecWatch *w=(ObjVecWatch*)watch;
+    VecHandle h;
+
+    h.slot=w->slot;
+    h.gen=w->ov->vec.slots[w->slot].gen;
+
+    ptrvec_remove_handle(&w->ov->vec, h);
+}
+
+
+static void reset_watch(ObjVec *ov, uint slot)
+{
+    watch_reset(&(watch_of(ov, slot)->watch));
+}
+
+
+/*}}}*/
+
+
+/*{{{ Insert and remove */
+
+
+void objvec_init(ObjVec *ov)
+{
+    ptrvec_init(&ov->vec);
+    ov->watches=NULL;
+    ov->nchunks=0;
+}
+
+
+static bool do_insert(ObjVec *ov, Obj *obj, VecHandle *h_ret, bool front)
+{
+    ObjVecWatch *w;
+    VecHandle h;
+
+    if(!(front
+         ? ptrvec_insert_first(&ov->vec, obj, &h)
+         : ptrvec_insert_last(&ov->vec, obj, &h))){
+        return FALSE;
+    }
+
+    if(!ensure_watch(ov, h.slot)){
+        ptrvec_remove_handle(&ov->vec, h);
+        return FALSE;
+    }
+
+    w=watch_of(ov, h.slot);
+    watch_init(&(w->watch));
+    w->ov=ov;
+    w->slot=h.slot;
+
+    if(!watch_setup(&(w->watch), obj, watch_handler)){
+        ptrvec_remove_handle(&ov->vec, h);
+        return FALSE;
+    }
+
+    if(h_ret!=NULL)
+        *h_ret=h;
+
+    return TRUE;
+}
+
+
+bool objvec_insert_last(ObjVec *ov, Obj *obj, VecHandle *h_ret)
+{
+    return do_insert(ov, obj, h_ret, FALSE);
+}
+
+
+bool objvec_insert_first(ObjVec *ov, Obj *obj, VecHandle *h_ret)
+{
+    return do_insert(ov, obj, h_ret, TRUE);
+}
+
+
+bool objvec_reinsert_last(ObjVec *ov, Obj *obj)
+{
+    if(!ptrvec_contains(&ov->vec, obj))
+        return do_insert(ov, obj, NULL, FALSE);
+
+    return ptrvec_reinsert_last(&ov->vec, obj);
+}
+
+
+bool objvec_reinsert_first(ObjVec *ov, Obj *obj)
+{
+    if(!ptrvec_contains(&ov->vec, obj))
+        return do_insert(ov, obj, NULL, TRUE);
+
+    return ptrvec_reinsert_first(&ov->vec, obj);
+}
+
+
+Obj *objvec_remove_handle(ObjVec *ov, VecHandle h)
+{
+    if(ptrvec_get(&ov->vec, h)==NULL)
+        return NULL;
+
+    reset_watch(ov, h.slot);
+
+    return (Obj*)ptrvec_remove_handle(&ov->vec, h);
+}
+
+
+bool objvec_remove(ObjVec *ov, Obj *obj)
+{
+    VecHandle h;
+
+    if(!ptrvec_find_handle(&ov->vec, obj, &h))
+        return FALSE;
+
+    objvec_remove_handle(ov, h);
+
+    return TRUE;
+}
+
+
+Obj *objvec_take_first(ObjVec *ov)
+{
+    PtrVec *vec=&ov->vec;
+    VecHandle h;
+
+    if(OBJVEC_EMPTY(ov))
+        return NULL;
+
+    h.slot=vec->entries[vec->first].slot;
+    h.gen=vec->slots[h.slot].gen;
+
+    return objvec_remove_handle(ov, h);
+}
+
+
+Obj *objvec_take_last(ObjVec *ov)
+{
+    PtrVec *vec=&ov->vec;
+    VecHandle h;
+
+    if(OBJVEC_EMPTY(ov))
+        return NULL;
+
+    h.slot=vec->entries[vec->end-1].slot;
+    h.gen=vec->slots[h.slot].gen;
+
+    return objvec_remove_handle(ov, h);
+}
+
+
+void objvec_clear(ObjVec *ov)
+{
+    PtrVec *vec=&ov->vec;
+    uint i;
+
+    for(i=vec->first; i<vec->end; i++){
+        if(vec->entries[i].ptr!=NULL)
+            reset_watch(ov, vec->entries[i].slot);
+    }
+
+    for(i=0; i<ov->nchunks; i++){
+        if(ov->watches[i]!=NULL)
+            free(ov->watches[i]);
+    }
+
+    if(ov->watches!=NULL)
+        free(ov->watches);
+
+    ov->watches=NULL;
+    ov->nchunks=0;
+
+    ptrvec_clear(vec);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Lookup and iteration */
+
+
+Obj *objvec_get(const ObjVec *ov, VecHandle h)
+{
+    return (Obj*)ptrvec_get(&ov->vec, h);
+}
+
+
+bool objvec_contains(const ObjVec *ov, Obj *obj)
+{
+    return ptrvec_contains(&ov->vec, obj);
+}
+
+
+void objvec_iter_init(ObjVecIterTmp *tmp, ObjVec *ov)
+{
+    ptrvec_iter_init(tmp, &ov->vec);
+}
+
+
+Obj *objvec_iter(ObjVecIterTmp *tmp)
+{
+    return (Obj*)ptrvec_iter(tmp);
+}
+
+
+void objvec_iter_rev_init(ObjVecIterTmp *tmp, ObjVec *ov)
+{
+    ptrvec_iter_rev_init(tmp, &ov->vec);
+}
+
+
+Obj *objvec_iter_rev(ObjVecIterTmp *tmp)
+{
+    return (Obj*)ptrvec_iter_rev(tmp);
+}
+
+
+/*}}}*/
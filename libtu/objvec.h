@@ -0,0 +1,68 @@
+/*
+ * libtu/objvec.h
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#ifndef LIBTU_OBJVEC_H
+#define LIBTU_OBJVEC_H
+
+#include "types.h"
+#include "iterable.h"
+#include "obj.h"
+#include "ptrvec.h"
+
+
+/* Vector of objects, an alternative to ObjList with the storage and
+ * handles of PtrVec. Objects are watched and drop off the vector when
+ * destroyed. An ObjVec must not be moved in memory while it holds
+ * objects.
+ */
+
+INTRSTRUCT(ObjVec);
+INTRSTRUCT(ObjVecWatch);
+
+DECLSTRUCT(ObjVec){
+    PtrVec vec;
+    ObjVecWatch **watches;
+    uint nchunks;
+};
+
+typedef PtrVecIterTmp ObjVecIterTmp;
+
+#define OBJVEC_INIT {PTRVEC_INIT, NULL, 0}
+
+#define OBJVEC_COUNT(OV) PTRVEC_COUNT(&(OV)->vec)
+#define OBJVEC_EMPTY(OV) PTRVEC_EMPTY(&(OV)->vec)
+#define OBJVEC_FIRST(TYPE, OV) PTRVEC_FIRST(TYPE, &(OV)->vec)
+#define OBJVEC_LAST(TYPE, OV) PTRVEC_LAST(TYPE, &(OV)->vec)
+
+#define FOR_ALL_ON_OBJVEC(TYPE, VAR, OV, TMP) \
+    FOR_ALL_ITER(objvec_iter_init, (TYPE)objvec_iter, VAR, OV, &(TMP))
+
+#define FOR_ALL_ON_OBJVEC_REV(TYPE, VAR, OV, TMP)         \
+    FOR_ALL_ITER(objvec_iter_rev_init,                    \
+                 (TYPE)objvec_iter_rev, VAR, OV, &(TMP))
+
+#define FOR_ALL_ON_OBJVEC_UNSAFE(TYPE, VAR, OV) \
+    FOR_ALL_ON_OBJVEC(TYPE, VAR, OV, ptrvec_iter_tmp)
+
+extern void objvec_init(ObjVec *ov);
+extern bool objvec_insert_last(ObjVec *ov, Obj *obj, VecHandle *h_ret);
+extern bool objvec_insert_first(ObjVec *ov, Obj *obj, VecHandle *h_ret);
+extern bool objvec_reinsert_last(ObjVec *ov, Obj *obj);
+extern bool objvec_reinsert_first(ObjVec *ov, Obj *obj);
+extern bool objvec_remove(ObjVec *ov, Obj *obj);
+extern Obj *objvec_remove_handle(ObjVec *ov, VecHandle h);
+extern Obj *objvec_get(const ObjVec *ov, VecHandle h);
+extern bool objvec_contains(const ObjVec *ov, Obj *obj);
+extern void objvec_clear(ObjVec *ov);
+extern void objvec_iter_init(ObjVecIterTmp *tmp, ObjVec *ov);
+extern Obj *objvec_iter(ObjVecIterTmp *tmp);
+extern void objvec_iter_rev_init(ObjVecIterTmp *tmp, ObjVec *ov);
+extern Obj *objvec_iter_rev(ObjVecIterTmp *tmp);
+extern Obj *objvec_take_first(ObjVec *ov);
+extern Obj *objvec_take_last(ObjVec *ov);
+
+#endif /* LIBTU_OBJVEC_H */
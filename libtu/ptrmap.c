@@ -0,0 +1,202 @@
+/*
+ * libtu/ptrmap.c
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#include <stdlib.h>
+
+#include "types.h"
+#include "misc.h"
+#include "ptrmap.h"
+
+
+/* Linear probing over a power-of-two table. Removed entries become
+ * tombstones, so that removal never moves other entries and is safe
+ * during iteration; the table is only rebuilt on insertion, when live
+ * entries and tombstones fill three quarters of it.
+ */
+
+static char tombstone;
+
+#define TOMBSTONE ((const void*)&tombstone)
+
+#define PTRMAP_MIN_SIZE 16
+
+
+static uint hash_ptr(const void *p)
+{
+    ulong h=(ulong)p;
+
+    h^=h>>4;
+    h*=2654435761UL;
+    h^=h>>16;
+
+    return (uint)h;
+}
+
+
+/* Index of 'key' in 'map', or -1. */
+static int find(const PtrMap *map, const void *key)
+{
+    uint mask, i;
+
+    if(map->size==0 || key==NULL)
+        return -1;
+
+    mask=map->size-1;
+    i=hash_ptr(key)&mask;
+
+    while(map->entries[i].key!=NULL){
+        if(map->entries[i].key==key)
+            return i;
+        i=(i+1)&mask;
+    }
+
+    return -1;
+}
+
+
+static void put(PtrMap *map, const void *key, void *val)
+{
+    uint mask=map->size-1;
+    uint i=hash_ptr(key)&mask;
+
+    while(map->entries[i].key!=NULL && map->entries[i].key!=TOMBSTONE)
+        i=(i+1)&mask;
+
+    if(map->entries[i].key==TOMBSTONE)
+        map->ntomb--;
+
+    map->entries[i].key=key;
+    map->entries[i].val=val;
+    map->n++;
+}
+
+
+static bool rehash(PtrMap *map, uint minn)
+{
+    PtrMapEntry *old=map->entries;
+    uint oldsize=map->size, size=PTRMAP_MIN_SIZE, i;
+
+    while(size<minn*2)
+        size*=2;
+
+    map->entries=ALLOC_N(PtrMapEntry, size);
+
+    if(map->entries==NULL){
+        map->entries=old;
+        return FALSE;
+    }
+
+    map->size=size;
+    map->n=0;
+    map->ntomb=0;
+
+    for(i=0; i<oldsize; i++){
+        if(old[i].key!=NULL && old[i].key!=TOMBSTONE)
+            put(map, old[i].key, old[i].val);
+    }
+
+    if(old!=NULL)
+        free(old);
+
+    return TRUE;
+}
+
+
+void *ptrmap_get(const PtrMap *map, const void *key)
+{
+    int i=find(map, key);
+
+    return (i<0 ? NULL : map->entries[i].val);
+}
+
+
+/* Setting a NULL value removes 'key'. */
+bool ptrmap_set(PtrMap *map, const void *key, void *val)
+{
+    int i;
+
+    if(key==NULL)
+        return FALSE;
+
+    if(val==NULL){
+        ptrmap_remove(map, key);
+        return TRUE;
+    }
+
+    i=find(map, key);
+
+    if(i>=0){
+        map->entries[i].val=val;
+        return TRUE;
+    }
+
+    if((map->n+map->ntomb+1)*4>map->size*3){
+        if(!rehash(map, map->n+1))
+            return FALSE;
+    }
+
+    put(map, key, val);
+
+    return TRUE;
+}
+
+
+/* Returns the removed value. */
+void *ptrmap_remove(PtrMap *map, const void *key)
+{
+    int i=find(map, key);
+    void *val;
+
+    if(i<0)
+        return NULL;
+
+    val=map->entries[i].val;
+    map->entries[i].key=TOMBSTONE;
+    map->entries[i].val=NULL;
+    map->n--;
+    map->ntomb++;
+
+    return val;
+}
+
+
+void ptrmap_clear(PtrMap *map)
+{
+    if(map->entries!=NULL)
+        free(map->entries);
+
+    map->entries=NULL;
+    map->size=0;
+    map->n=0;
+    map->ntomb=0;
+}
+
+
+void ptrmap_iter_init(PtrMapIterTmp *tmp, PtrMap *map)
+{
+    tmp->map=map;
+    tmp->i=0;
+    tmp->key=NULL;
+}
+
+
+/* Returns the next value; its key is left in tmp->key. */
+void *ptrmap_iter(PtrMapIterTmp *tmp)
+{
+    PtrMap *map=tmp->map;
+
+    while(tmp->i<map->size){
+        PtrMapEntry *e=&map->entries[tmp->i++];
+        if(e->key!=NULL && e->key!=TOMBSTONE){
+            tmp->key=e->key;
+            return e->val;
+        }
+    }
+
+    tmp->key=NULL;
+    return NULL;
+}
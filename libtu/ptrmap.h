@@ -0,0 +1,57 @@
+/*
+ * libtu/ptrmap.h
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#ifndef LIBTU_PTRMAP_H
+#define LIBTU_PTRMAP_H
+
+#include "types.h"
+#include "obj.h"
+#include "iterable.h"
+
+
+/* Open-addressed hash map from non-NULL pointers to non-NULL values,
+ * keyed on pointer identity. Entries may be removed while iterating
+ * over the map, but not inserted.
+ */
+
+INTRSTRUCT(PtrMap);
+INTRSTRUCT(PtrMapEntry);
+INTRSTRUCT(PtrMapIterTmp);
+
+DECLSTRUCT(PtrMapEntry){
+    const void *key;
+    void *val;
+};
+
+DECLSTRUCT(PtrMap){
+    PtrMapEntry *entries;
+    uint size;
+    uint n;
+    uint ntomb;
+};
+
+DECLSTRUCT(PtrMapIterTmp){
+    PtrMap *map;
+    uint i;
+    const void *key;
+};
+
+#define PTRMAP_INIT {NULL, 0, 0, 0}
+
+#define PTRMAP_COUNT(MAP) ((MAP)->n)
+
+#define FOR_ALL_ON_PTRMAP(TYPE, VAR, MAP, TMP) \
+    FOR_ALL_ITER(ptrmap_iter_init, (TYPE)ptrmap_iter, VAR, MAP, &(TMP))
+
+extern void *ptrmap_get(const PtrMap *map, const void *key);
+extern bool ptrmap_set(PtrMap *map, const void *key, void *val);
+extern void *ptrmap_remove(PtrMap *map, const void *key);
+extern void ptrmap_clear(PtrMap *map);
+extern void ptrmap_iter_init(PtrMapIterTmp *tmp, PtrMap *map);
+extern void *ptrmap_iter(PtrMapIterTmp *tmp);
+
+#endif /* LIBTU_PTRMAP_H */
@@ -0,0 +1,414 @@
+/*
+ * libtu/ptrvec.c
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#include <stdlib.h>
+
+#include "types.h"
+#include "misc.h"
+#include "ptrvec.h"
+
+
+/* Elements are kept in order in entries[first..end-1]. Removal leaves a
+ * hole (NULL) that is skipped by iteration, and holes at either end are
+ * trimmed off at once, so that the first and last entries are always
+ * live. Holes are only squeezed out when insertion runs out of room at
+ * the end it inserts at; the storage is then rebuilt with as much free
+ * room as there are live elements, which keeps insertion amortised O(1)
+ * at both ends.
+ *
+ * Handles index a separate slot table that records the position of
+ * each element and a generation count, odd while the slot is in use.
+ * Free slots are chained through their 'pos' fields.
+ */
+
+#define NOSLOT ((uint)-1)
+
+#define PTRVEC_MIN_SIZE 8
+
+
+/*{{{ Slots */
+
+
+static uint alloc_slot(PtrVec *vec)
+{
+    uint s;
+
+    if(vec->freeslot==NOSLOT){
+        uint n=(vec->nslots==0 ? PTRVEC_MIN_SIZE : vec->nslots*2);
+        PtrVecSlot *slots=REALLOC_N(vec->slots, PtrVecSlot, vec->nslots, n);
+
+        if(slots==NULL)
+            return NOSLOT;
+
+        for(s=n; s>vec->nslots; s--){
+            slots[s-1].pos=vec->freeslot;
+            vec->freeslot=s-1;
+        }
+
+        vec->slots=slots;
+        vec->nslots=n;
+    }
+
+    s=vec->freeslot;
+    vec->freeslot=vec->slots[s].pos;
+    vec->slots[s].gen++;
+
+    return s;
+}
+
+
+static void free_slot(PtrVec *vec, uint s)
+{
+    vec->slots[s].gen++;
+    vec->slots[s].pos=vec->freeslot;
+    vec->freeslot=s;
+}
+
+
+static bool handle_ok(const PtrVec *vec, VecHandle h)
+{
+    return (h.slot<vec->nslots && (h.gen&1)
+            && vec->slots[h.slot].gen==h.gen);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Storage */
+
+
+static bool relayout(PtrVec *vec, bool front)
+{
+    uint cap=PTRVEC_MIN_SIZE, i, j;
+    PtrVecEntry *entries;
+
+    while(cap<(vec->n+1)*2)
+        cap*=2;
+
+    entries=ALLOC_N(PtrVecEntry, cap);
+
+    if(entries==NULL)
+        return FALSE;
+
+    j=(front ? (cap-vec->n)/2 : 0);
+
+    for(i=vec->first; i<vec->end; i++){
+        if(vec->entries[i].ptr!=NULL){
+            entries[j]=vec->entries[i];
+            vec->slots[entries[j].slot].pos=j;
+            j++;
+        }
+    }
+
+    if(vec->entries!=NULL)
+        free(vec->entries);
+
+    vec->entries=entries;
+    vec->cap=cap;
+    vec->end=j;
+    vec->first=j-vec->n;
+
+    return TRUE;
+}
+
+
+static bool make_room(PtrVec *vec, bool front)
+{
+    if(front ? vec->first>0 : vec->end<vec->cap)
+        return TRUE;
+
+    return relayout(vec, front);
+}
+
+
+static void put(PtrVec *vec, void *ptr, uint s, bool front)
+{
+    uint pos=(front ? --vec->first : vec->end++);
+
+    vec->entries[pos].ptr=ptr;
+    vec->entries[pos].slot=s;
+    vec->slots[s].pos=pos;
+    vec->n++;
+}
+
+
+/* Leaves the slot of the entry in use. */
+static void unput(PtrVec *vec, uint pos)
+{
+    vec->entries[pos].ptr=NULL;
+    vec->n--;
+
+    while(vec->first<vec->end && vec->entries[vec->first].ptr==NULL)
+        vec->first++;
+    while(vec->end>vec->first && vec->entries[vec->end-1].ptr==NULL)
+        vec->end--;
+}
+
+
+static int find_pos(const PtrVec *vec, void *ptr)
+{
+    uint i;
+
+    if(ptr==NULL)
+        return -1;
+
+    for(i=vec->first; i<vec->end; i++){
+        if(vec->entries[i].ptr==ptr)
+            return i;
+    }
+
+    return -1;
+}
+
+
+static void *remove_at(PtrVec *vec, uint pos)
+{
+    void *ptr=vec->entries[pos].ptr;
+    uint s=vec->entries[pos].slot;
+
+    unput(vec, pos);
+    free_slot(vec, s);
+
+    return ptr;
+}
+
+
+/*}}}*/
+
+
+/*{{{ Insert and remove */
+
+
+void ptrvec_init(PtrVec *vec)
+{
+    vec->entries=NULL;
+    vec->first=0;
+    vec->end=0;
+    vec->cap=0;
+    vec->n=0;
+    vec->slots=NULL;
+    vec->nslots=0;
+    vec->freeslot=NOSLOT;
+}
+
+
+static bool do_insert(PtrVec *vec, void *ptr, VecHandle *h_ret, bool front)
+{
+    uint s;
+
+    if(ptr==NULL)
+        return FALSE;
+
+    s=alloc_slot(vec);
+
+    if(s==NOSLOT)
+        return FALSE;
+
+    if(!make_room(vec, front)){
+        free_slot(vec, s);
+        return FALSE;
+    }
+
+    put(vec, ptr, s, front);
+
+    if(h_ret!=NULL){
+        h_ret->slot=s;
+        h_ret->gen=vec->slots[s].gen;
+    }
+
+    return TRUE;
+}
+
+
+bool ptrvec_insert_last(PtrVec *vec, void *ptr, VecHandle *h_ret)
+{
+    return do_insert(vec, ptr, h_ret, FALSE);
+}
+
+
+bool ptrvec_insert_first(PtrVec *vec, void *ptr, VecHandle *h_ret)
+{
+    return do_insert(vec, ptr, h_ret, TRUE);
+}
+
+
+/* Moves 'ptr' to the given end, keeping its handle, or inserts it if
+ * it is not on the vector.
+ */
+static bool do_reinsert(PtrVec *vec, void *ptr, bool front)
+{
+    int pos=find_pos(vec, ptr);
+    uint s;
+
+    if(pos<0)
+        return do_insert(vec, ptr, NULL, front);
+
+    if((uint)pos==(front ? vec->first : vec->end-1))
+        return TRUE;
+
+    s=vec->entries[pos].slot;
+
+    if(!make_room(vec, front))
+        return FALSE;
+
+    unput(vec, vec->slots[s].pos);
+    put(vec, ptr, s, front);
+
+    return TRUE;
+}
+
+
+bool ptrvec_reinsert_last(PtrVec *vec, void *ptr)
+{
+    return do_reinsert(vec, ptr, FALSE);
+}
+
+
+bool ptrvec_reinsert_first(PtrVec *vec, void *ptr)
+{
+    return do_reinsert(vec, ptr, TRUE);
+}
+
+
+bool ptrvec_remove(PtrVec *vec, void *ptr)
+{
+    int pos=find_pos(vec, ptr);
+
+    if(pos<0)
+        return FALSE;
+
+    remove_at(vec, pos);
+
+    return TRUE;
+}
+
+
+/* Returns the removed element, or NULL if the handle is stale. */
+void *ptrvec_remove_handle(PtrVec *vec, VecHandle h)
+{
+    if(!handle_ok(vec, h))
+        return NULL;
+
+    return remove_at(vec, vec->slots[h.slot].pos);
+}
+
+
+void *ptrvec_take_first(PtrVec *vec)
+{
+    return (vec->n==0 ? NULL : remove_at(vec, vec->first));
+}
+
+
+void *ptrvec_take_last(PtrVec *vec)
+{
+    return (vec->n==0 ? NULL : remove_at(vec, vec->end-1));
+}
+
+
+void ptrvec_clear(PtrVec *vec)
+{
+    if(vec->entries!=NULL)
+        free(vec->entries);
+    if(vec->slots!=NULL)
+        free(vec->slots);
+
+    ptrvec_init(vec);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Lookup */
+
+
+/* Returns NULL if the handle is stale. */
+void *ptrvec_get(const PtrVec *vec, VecHandle h)
+{
+    if(!handle_ok(vec, h))
+        return NULL;
+
+    return vec->entries[vec->slots[h.slot].pos].ptr;
+}
+
+
+bool ptrvec_find_handle(const PtrVec *vec, void *ptr, VecHandle *h_ret)
+{
+    int pos=find_pos(vec, ptr);
+
+    if(pos<0)
+        return FALSE;
+
+    h_ret->slot=vec->entries[pos].slot;
+    h_ret->gen=vec->slots[h_ret->slot].gen;
+
+    return TRUE;
+}
+
+
+bool ptrvec_contains(const PtrVec *vec, void *ptr)
+{
+    return (find_pos(vec, ptr)>=0);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Iteration */
+
+
+PtrVecIterTmp ptrvec_iter_tmp={NULL, 0};
+
+
+void ptrvec_iter_init(PtrVecIterTmp *tmp, PtrVec *vec)
+{
+    tmp->vec=vec;
+    tmp->i=vec->first;
+}
+
+
+void *ptrvec_iter(PtrVecIterTmp *tmp)
+{
+    PtrVec *vec=tmp->vec;
+
+    while(tmp->i<vec->end){
+        void *ptr=vec->entries[tmp->i++].ptr;
+        if(ptr!=NULL)
+            return ptr;
+    }
+
+    return NULL;
+}
+
+
+void ptrvec_iter_rev_init(PtrVecIterTmp *tmp, PtrVec *vec)
+{
+    tmp->vec=vec;
+    tmp->i=vec->end;
+}
+
+
+void *ptrvec_iter_rev(PtrVecIterTmp *tmp)
+{
+    PtrVec *vec=tmp->vec;
+
+    if(tmp->i>vec->end)
+        tmp->i=vec->end;
+
+    while(tmp->i>vec->first){
+        void *ptr=vec->entries[--tmp->i].ptr;
+        if(ptr!=NULL)
+            return ptr;
+    }
+
+    return NULL;
+}
+
+
+/*}}}*/
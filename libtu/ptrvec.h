@@ -0,0 +1,100 @@
+/*
+ * libtu/ptrvec.h
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#ifndef LIBTU_PTRVEC_H
+#define LIBTU_PTRVEC_H
+
+#include "types.h"
+#include "obj.h"
+#include "iterable.h"
+
+
+/* Ordered list of non-NULL pointers in contiguous storage, an
+ * alternative to PtrList. Every element has a handle that stays valid
+ * until the element is removed, also across reinsertion and storage
+ * moves; stale handles are detected by a generation count. Elements may
+ * be removed while iterating over the vector, but not inserted.
+ */
+
+INTRSTRUCT(PtrVec);
+INTRSTRUCT(PtrVecEntry);
+INTRSTRUCT(PtrVecSlot);
+INTRSTRUCT(PtrVecIterTmp);
+INTRSTRUCT(VecHandle);
+
+DECLSTRUCT(VecHandle){
+    uint slot;
+    uint gen;
+};
+
+DECLSTRUCT(PtrVecEntry){
+    void *ptr;
+    uint slot;
+};
+
+DECLSTRUCT(PtrVecSlot){
+    uint pos;
+    uint gen;
+};
+
+DECLSTRUCT(PtrVec){
+    PtrVecEntry *entries;
+    uint first, end, cap;
+    uint n;
+    PtrVecSlot *slots;
+    uint nslots;
+    uint freeslot;
+};
+
+DECLSTRUCT(PtrVecIterTmp){
+    PtrVec *vec;
+    uint i;
+};
+
+#define VECHANDLE_NONE {0, 0}
+
+#define PTRVEC_INIT {NULL, 0, 0, 0, 0, NULL, 0, (uint)-1}
+
+#define PTRVEC_COUNT(VEC) ((VEC)->n)
+#define PTRVEC_EMPTY(VEC) ((VEC)->n==0)
+#define PTRVEC_FIRST(TYPE, VEC) \
+    ((VEC)->n==0 ? NULL : (TYPE)(VEC)->entries[(VEC)->first].ptr)
+#define PTRVEC_LAST(TYPE, VEC) \
+    ((VEC)->n==0 ? NULL : (TYPE)(VEC)->entries[(VEC)->end-1].ptr)
+
+#define FOR_ALL_ON_PTRVEC(TYPE, VAR, VEC, TMP) \
+    FOR_ALL_ITER(ptrvec_iter_init, (TYPE)ptrvec_iter, VAR, VEC, &(TMP))
+
+#define FOR_ALL_ON_PTRVEC_REV(TYPE, VAR, VEC, TMP)        \
+    FOR_ALL_ITER(ptrvec_iter_rev_init,                    \
+                 (TYPE)ptrvec_iter_rev, VAR, VEC, &(TMP))
+
+#define FOR_ALL_ON_PTRVEC_UNSAFE(TYPE, VAR, VEC) \
+    FOR_ALL_ON_PTRVEC(TYPE, VAR, VEC, ptrvec_iter_tmp)
+
+extern PtrVecIterTmp ptrvec_iter_tmp;
+
+extern void ptrvec_init(PtrVec *vec);
+extern bool ptrvec_insert_last(PtrVec *vec, void *ptr, VecHandle *h_ret);
+extern bool ptrvec_insert_first(PtrVec *vec, void *ptr, VecHandle *h_ret);
+extern bool ptrvec_reinsert_last(PtrVec *vec, void *ptr);
+extern bool ptrvec_reinsert_first(PtrVec *vec, void *ptr);
+extern bool ptrvec_remove(PtrVec *vec, void *ptr);
+extern void *ptrvec_remove_handle(PtrVec *vec, VecHandle h);
+extern void *ptrvec_get(const PtrVec *vec, VecHandle h);
+extern bool ptrvec_find_handle(const PtrVec *vec, void *ptr,
+                               VecHandle *h_ret);
+extern bool ptrvec_contains(const PtrVec *vec, void *ptr);
+extern void ptrvec_clear(PtrVec *vec);
+extern void ptrvec_iter_init(PtrVecIterTmp *tmp, PtrVec *vec);
+extern void *ptrvec_iter(PtrVecIterTmp *tmp);
+extern void ptrvec_iter_rev_init(PtrVecIterTmp *tmp, PtrVec *vec);
+extern void *ptrvec_iter_rev(PtrVecIterTmp *tmp);
+extern void *ptrvec_take_first(PtrVec *vec);
+extern void *ptrvec_take_last(PtrVec *vec);
+
+#endif /* LIBTU_PTRVEC_H */
@@ -0,0 +1,269 @@
+/*
+ * libtu/slab.c
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+/* For posix_memalign in the standalone -ansi -D_POSIX_SOURCE build. */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "types.h"
+#include "misc.h"
+#include "dlist.h"
+#include "slab.h"
+
+
+/* Small allocations are served from size classes. Each class carves
+ * objects out of slabs of SLAB_SIZE bytes aligned to SLAB_SIZE, so the
+ * slab of an object is found by masking its address and no per-object
+ * header is needed. Slabs with free objects are kept on the 'partial'
+ * list of their class; full slabs are on no list. A slab that becomes
+ * entirely free is returned to malloc, except that one is kept per
+ * class to avoid thrashing.
+ */
+
+#define SLAB_SIZE 65536
+#define SLAB_HDR_SIZE ((sizeof(Slab)+15)&~(size_t)15)
+
+
+INTRSTRUCT(Slab);
+INTRSTRUCT(SlabClass);
+
+DECLSTRUCT(Slab){
+    SlabClass *cls;
+    Slab *next, *prev;
+    void *freelist;
+    uint nfree;
+    uint nfresh;
+};
+
+DECLSTRUCT(SlabClass){
+    uint size;
+    uint capacity;
+    Slab *partial;
+    Slab *empty;
+    ulong live;
+    ulong peak;
+    ulong slabs;
+};
+
+
+static const uint class_sizes[]={
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024, 1280, 1536, 1792, 2048
+};
+
+#define N_CLASSES ((int)(sizeof(class_sizes)/sizeof(class_sizes[0])))
+
+static SlabClass classes[N_CLASSES];
+static uchar size_to_class[SLAB_MAX_SIZE/16+1];
+static bool slab_initialised=FALSE;
+
+
+static void slab_init()
+{
+    int c=0;
+    uint u;
+
+    for(u=0; u<=SLAB_MAX_SIZE/16; u++){
+        while(class_sizes[c]<u*16)
+            c++;
+        size_to_class[u]=c;
+    }
+
+    for(c=0; c<N_CLASSES; c++){
+        classes[c].size=class_sizes[c];
+        classes[c].capacity=(SLAB_SIZE-SLAB_HDR_SIZE)/class_sizes[c];
+        classes[c].partial=NULL;
+        classes[c].empty=NULL;
+        classes[c].live=0;
+        classes[c].peak=0;
+        classes[c].slabs=0;
+    }
+
+    slab_initialised=TRUE;
+}
+
+
+static SlabClass *get_class(size_t size)
+{
+    if(!slab_initialised)
+        slab_init();
+
+    return &classes[size_to_class[(size+15)/16]];
+}
+
+
+/*{{{ Slabs */
+
+
+static Slab *slab_of(void *p)
+{
+    return (Slab*)((ulong)p&~(ulong)(SLAB_SIZE-1));
+}
+
+
+static void reset_slab(Slab *slab)
+{
+    slab->freelist=NULL;
+    slab->nfree=slab->cls->capacity;
+    slab->nfresh=0;
+    slab->next=NULL;
+    slab->prev=NULL;
+}
+
+
+static Slab *get_slab(SlabClass *cls)
+{
+    void *mem;
+    Slab *slab;
+
+    if(cls->empty!=NULL){
+        slab=cls->empty;
+        cls->empty=NULL;
+        return slab;
+    }
+
+    if(posix_memalign(&mem, SLAB_SIZE, SLAB_SIZE)!=0)
+        return NULL;
+
+    slab=(Slab*)mem;
+    slab->cls=cls;
+    reset_slab(slab);
+    cls->slabs++;
+
+    return slab;
+}
+
+
+static void release_slab(SlabClass *cls, Slab *slab)
+{
+    if(cls->empty==NULL){
+        reset_slab(slab);
+        cls->empty=slab;
+    }else{
+        free(slab);
+        cls->slabs--;
+    }
+}
+
+
+/*}}}*/
+
+
+/*{{{ Alloc/free */
+
+
+/* Zeroed allocation of 'size' bytes; 'size' must be at most
+ * SLAB_MAX_SIZE. Returns NULL on failure without warning.
+ */
+void *slab_alloc(size_t size)
+{
+    SlabClass *cls;
+    void *p;
+    Slab *slab;
+
+    if(size>SLAB_MAX_SIZE)
+        return NULL;
+
+    cls=get_class(size);
+
+    slab=cls->partial;
+
+    if(slab==NULL){
+        slab=get_slab(cls);
+        if(slab==NULL)
+            return NULL;
+        LINK_ITEM(cls->partial, slab, next, prev);
+    }
+
+    if(slab->freelist!=NULL){
+        p=slab->freelist;
+        slab->freelist=*(void**)p;
+    }else{
+        p=(char*)slab+SLAB_HDR_SIZE+slab->nfresh*cls->size;
+        slab->nfresh++;
+    }
+
+    slab->nfree--;
+
+    if(slab->nfree==0){
+        UNLINK_ITEM(cls->partial, slab, next, prev);
+    }
+
+    memset(p, 0, size);
+
+    cls->live++;
+    if(cls->live>cls->peak)
+        cls->peak=cls->live;
+
+    return p;
+}
+
+
+void slab_free(void *p)
+{
+    Slab *slab;
+    SlabClass *cls;
+
+    if(p==NULL)
+        return;
+
+    slab=slab_of(p);
+    cls=slab->cls;
+
+    *(void**)p=slab->freelist;
+    slab->freelist=p;
+
+    if(slab->nfree==0){
+        LINK_ITEM(cls->partial, slab, next, prev);
+    }
+
+    slab->nfree++;
+    cls->live--;
+
+    if(slab->nfree==cls->capacity){
+        UNLINK_ITEM(cls->partial, slab, next, prev);
+        release_slab(cls, slab);
+    }
+}
+
+
+/*}}}*/
+
+
+/*{{{ Statistics */
+
+
+int slab_nclasses()
+{
+    return N_CLASSES;
+}
+
+
+bool slab_get_stats(int c, SlabStats *ret)
+{
+    if(c<0 || c>=N_CLASSES)
+        return FALSE;
+
+    if(!slab_initialised)
+        slab_init();
+
+    ret->size=classes[c].size;
+    ret->live=classes[c].live;
+    ret->peak=classes[c].peak;
+    ret->slabs=classes[c].slabs;
+    ret->bytes=classes[c].slabs*SLAB_SIZE;
+
+    return TRUE;
+}
+
+
+/*}}}*/
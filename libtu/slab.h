@@ -0,0 +1,50 @@
+/*
+ * libtu/slab.h
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#ifndef LIBTU_SLAB_H
+#define LIBTU_SLAB_H
+
+#include <stdlib.h>
+#include "types.h"
+#include "obj.h"
+#include "misc.h"
+
+/* Objects larger than this are not pooled. */
+#define SLAB_MAX_SIZE 2048
+
+INTRSTRUCT(SlabStats);
+
+DECLSTRUCT(SlabStats){
+    uint size;
+    ulong live;
+    ulong peak;
+    ulong slabs;
+    ulong bytes;
+};
+
+extern void *slab_alloc(size_t size);
+extern void slab_free(void *p);
+extern int slab_nclasses();
+extern bool slab_get_stats(int cls, SlabStats *ret);
+
+/* Zeroed allocation of a single X from its size class, falling back
+ * to malloc for large types. Free with SLAB_FREE on the same type.
+ */
+#define SLAB_ALLOC(X)                                       \
+    (X*)(sizeof(X)<=SLAB_MAX_SIZE                           \
+         ? slab_alloc(sizeof(X))                            \
+         : malloczero(sizeof(X)))
+
+#define SLAB_FREE(X, P)                                     \
+    do{                                                     \
+        if(sizeof(X)<=SLAB_MAX_SIZE)                        \
+            slab_free(P);                                   \
+        else                                                \
+            free(P);                                        \
+    }while(0)
+
+#endif /* LIBTU_SLAB_H */
@@ -8,60 +8,136 @@
  */
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "misc.h"
 #include "output.h"
-#include "rb.h"
+#include "slab.h"
 #include "stringstore.h"
 
 
-static Rb_node stringstore=NULL;
+/* Strings are interned in a chained hash table. Each string lives in an
+ * entry that also holds its cached hash, length and reference count, and
+ * a StringId is a pointer to the entry, so ids stay valid while the table
+ * grows. Entries are carved from the slab allocator's size classes; only
+ * very long strings go to malloc.
+ */
 
+INTRSTRUCT(StrEntry);
 
-const char *stringstore_get(StringId id)
+DECLSTRUCT(StrEntry){
+    StrEntry *next;
+    uint hash;
+    uint len;
+    int refcount;
+    char str[1];
+};
+
+#define ENTRY_SIZE(L) (offsetof(StrEntry, str)+(L)+1)
+
+#define STRINGSTORE_MIN_SIZE 256
+
+
+static StrEntry **buckets=NULL;
+static uint nbuckets=0;
+static uint nentries=0;
+
+
+/*{{{ Hashing and the table */
+
+
+/* FNV-1a */
+static uint hash_str(const char *str, uint l)
 {
-    return (id==STRINGID_NONE
-            ? NULL
-            : (const char*)(((Rb_node)id)->k.key));
+    uint h=2166136261U;
+    uint i;
+
+    for(i=0; i<l; i++){
+        h^=(uchar)str[i];
+        h*=16777619U;
+    }
+
+    return h;
 }
 
 
-typedef struct{
-    const char *key;
-    uint len;
-} D;
+static bool grow(void)
+{
+    uint size=(nbuckets==0 ? STRINGSTORE_MIN_SIZE : nbuckets*2);
+    StrEntry **nb=ALLOC_N(StrEntry*, size);
+    uint i;
+
+    if(nb==NULL)
+        return FALSE;
+
+    for(i=0; i<nbuckets; i++){
+        StrEntry *e=buckets[i], *next;
+        for(; e!=NULL; e=next){
+            next=e->next;
+            e->next=nb[e->hash&(size-1)];
+            nb[e->hash&(size-1)]=e;
+        }
+    }
+
+    if(buckets!=NULL)
+        free(buckets);
 
-static int cmp(const void *d_, const char *nodekey)
+    buckets=nb;
+    nbuckets=size;
+
+    return TRUE;
+}
+
+
+static StrEntry *lookup(const char *str, uint l, uint h)
 {
-    D *d=(D*)d_;
+    StrEntry *e;
 
-    int res=strncmp(d->key, nodekey, d->len);
+    if(nbuckets==0)
+        return NULL;
 
-    return (res!=0
-            ? res
-            : (nodekey[d->len]=='\0' ? 0 : -1));
+    for(e=buckets[h&(nbuckets-1)]; e!=NULL; e=e->next){
+        if(e->hash==h && e->len==l && memcmp(e->str, str, l)==0)
+            return e;
+    }
+
+    return NULL;
 }
 
 
-StringId stringstore_find_n(const char *str, uint l)
+static void free_entry(StrEntry *e)
 {
-    Rb_node node;
-    int found=0;
-    D d;
+    if(ENTRY_SIZE(e->len)<=SLAB_MAX_SIZE)
+        slab_free(e);
+    else
+        free(e);
+}
+
+
+/*}}}*/
 
-    if(stringstore==NULL)
-        return STRINGID_NONE;
 
-    d.key=str;
-    d.len=l;
+/*{{{ Interface */
+
+
+const char *stringstore_get(StringId id)
+{
+    return (id==STRINGID_NONE
+            ? NULL
+            : (const char*)((StrEntry*)id)->str);
+}
 
-    node=rb_find_gkey_n(stringstore, &d, (Rb_compfn*)cmp, &found);
 
-    if(!found)
+/* The 'l' first bytes of 'str' are looked up; 'str' need not be
+ * NUL-terminated.
+ */
+StringId stringstore_find_n(const char *str, uint l)
+{
+    if(nentries==0)
         return STRINGID_NONE;
 
-    return (StringId)node;
+    return (StringId)lookup(str, l, hash_str(str, l));
 }
 
 
@@ -73,33 +149,38 @@ StringId stringstore_find(const char *str)
 
 StringId stringstore_alloc_n(const char *str, uint l)
 {
-    Rb_node node=(Rb_node)stringstore_find_n(str, l);
-    char *s;
-
-    if(node!=NULL){
-        node->v.ival++;
-        return node;
+    uint h=hash_str(str, l);
+    StrEntry *e=lookup(str, l, h);
+    size_t size=ENTRY_SIZE(l);
+    uint b;
+
+    if(e!=NULL){
+        e->refcount++;
+        return (StringId)e;
     }
 
-    if(stringstore==NULL){
-        stringstore=make_rb();
-        if(stringstore==NULL)
+    if(nentries>=nbuckets){
+        if(!grow() && nbuckets==0)
             return STRINGID_NONE;
     }
 
-    s=scopyn(str, l);
+    e=(StrEntry*)(size<=SLAB_MAX_SIZE ? slab_alloc(size) : malloc(size));
 
-    if(s==NULL)
+    if(e==NULL)
         return STRINGID_NONE;
 
-    node=rb_insert(stringstore, s, NULL);
-
-    if(node==NULL)
-        return STRINGID_NONE;
+    memcpy(e->str, str, l);
+    e->str[l]='\0';
+    e->len=l;
+    e->hash=h;
+    e->refcount=1;
 
-    node->v.ival=1;
+    b=h&(nbuckets-1);
+    e->next=buckets[b];
+    buckets[b]=e;
+    nentries++;
 
-    return (StringId)node;
+    return (StringId)e;
 }
 
 
@@ -114,40 +195,61 @@ StringId stringstore_alloc(const char *str)
 
 void stringstore_free(StringId id)
 {
-    Rb_node node=(Rb_node)id;
+    StrEntry *e=(StrEntry*)id, **p;
 
-    if(node==NULL)
+    if(e==NULL)
         return;
 
-    if(node->v.ival<=0){
+    if(e->refcount<=0){
         warn("Stringstore reference count corrupted.");
         return;
     }
 
-    node->v.ival--;
+    e->refcount--;
 
-    if(node->v.ival==0){
-        char *s=(char*)(node->k.key);
-        rb_delete_node(node);
-        free(s);
+    if(e->refcount>0)
+        return;
+
+    for(p=&buckets[e->hash&(nbuckets-1)]; *p!=NULL; p=&(*p)->next){
+        if(*p==e){
+            *p=e->next;
+            break;
+        }
     }
+
+    nentries--;
+    free_entry(e);
 }
 
 
 void stringstore_ref(StringId id)
 {
-    Rb_node node=(Rb_node)id;
+    StrEntry *e=(StrEntry*)id;
 
-    if(node!=NULL)
-        node->v.ival++;
+    if(e!=NULL)
+        e->refcount++;
 }
 
-void stringstore_deinit(void) {
-    if(stringstore!=NULL){
-        Rb_node node;
-        while ((node=rb_first(stringstore))!=rb_nil(stringstore)) {
-            node->v.ival = 1;
-            stringstore_free((StringId)node);
+
+void stringstore_deinit(void)
+{
+    uint i;
+
+    for(i=0; i<nbuckets; i++){
+        while(buckets[i]!=NULL){
+            StrEntry *e=buckets[i];
+            buckets[i]=e->next;
+            free_entry(e);
         }
     }
+
+    if(buckets!=NULL)
+        free(buckets);
+
+    buckets=NULL;
+    nbuckets=0;
+    nentries=0;
 }
+
+
+/*}}}*/
@@ -0,0 +1,127 @@
+/*
+ * libtu/test/bench.h
+ *
+ * Helpers for the benchmark suites (tubench, extlbench). Each case is
+ * run BENCH_REPEAT times and the fastest run is reported as one
+ * tab-separated line:
+ *
+ *   <case> <ns/op> <allocs/op>
+ *
+ * Allocations are counted by wrapping the allocator functions at link
+ * time; link with $(BENCH_LDFLAGS). Include in one file per program only.
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#ifndef LIBTU_TEST_BENCH_H
+#define LIBTU_TEST_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_REPEAT 5
+
+static volatile long bench_sink;
+static unsigned long bench_allocs=0;
+
+
+/*{{{ Allocation counting */
+
+
+extern void *__real_malloc(size_t size);
+extern void *__real_calloc(size_t n, size_t size);
+extern void *__real_realloc(void *ptr, size_t size);
+extern int __real_posix_memalign(void **ptr, size_t align, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    bench_allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    bench_allocs++;
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    bench_allocs++;
+    return __real_realloc(ptr, size);
+}
+
+int __wrap_posix_memalign(void **ptr, size_t align, size_t size)
+{
+    bench_allocs++;
+    return __real_posix_memalign(ptr, align, size);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Timing */
+
+
+static double bench_now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1e9+ts.tv_nsec;
+}
+
+
+static void bench_header()
+{
+    printf("# case\tns/op\tallocs/op\n");
+}
+
+
+static void bench_report(const char *name, double ns, unsigned long allocs,
+                         long ops)
+{
+    printf("%s\t%.2f\t%.3f\n", name, ns/ops, (double)allocs/ops);
+    fflush(stdout);
+}
+
+
+/* Times BODY run OPS times, with 'bench_i' counting from 0 to OPS-1.
+ * SETUP and TEARDOWN are run around each repetition, untimed.
+ */
+#define BENCH_SETUP(NAME, OPS, SETUP, BODY, TEARDOWN)               \
+    do{                                                             \
+        double best_=-1;                                            \
+        unsigned long allocs_=0;                                    \
+        int rep_;                                                   \
+        for(rep_=0; rep_<BENCH_REPEAT; rep_++){                     \
+            unsigned long a_;                                       \
+            long bench_i;                                           \
+            double t_;                                              \
+            SETUP;                                                  \
+            a_=bench_allocs;                                        \
+            t_=bench_now_ns();                                      \
+            for(bench_i=0; bench_i<(OPS); bench_i++){               \
+                BODY;                                               \
+            }                                                       \
+            t_=bench_now_ns()-t_;                                   \
+            a_=bench_allocs-a_;                                     \
+            TEARDOWN;                                               \
+            if(best_<0 || t_<best_){                                \
+                best_=t_;                                           \
+                allocs_=a_;                                         \
+            }                                                       \
+        }                                                           \
+        bench_report(NAME, best_, allocs_, OPS);                    \
+    }while(0)
+
+#define BENCH(NAME, OPS, BODY) \
+    BENCH_SETUP(NAME, OPS, (void)0, BODY, (void)0)
+
+
+/*}}}*/
+
+
+#endif /* LIBTU_TEST_BENCH_H */
@@ -0,0 +1,426 @@
+/*
+ * libtu/test/tubench.c
+ *
+ * Benchmark suite for the libtu primitives on the window manager's hot
+ * paths: dynfun dispatch, subclass tests, object creation, watches,
+ * pointer maps, the stringstore, list iteration and UTF-8 scanning.
+ * Output is described in bench.h. Containers hold N elements unless the
+ * case name ends in a size; iteration cases time one full traversal per
+ * op, and UTF-8 cases one scan of a string of the given size.
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <locale.h>
+#include <wchar.h>
+
+#include "../obj.h"
+#include "../objp.h"
+#include "../misc.h"
+#include "../output.h"
+#include "../rb.h"
+#include "../stringstore.h"
+#include "../objlist.h"
+#include "../ptrlist.h"
+#include "../objvec.h"
+#include "../ptrvec.h"
+#include "../ptrmap.h"
+#include "../slab.h"
+#include "../utf8.h"
+#include "bench.h"
+
+#define N 1024
+#define OPS 1000000
+#define TRAVERSALS 2000
+
+
+/*{{{ A small class hierarchy */
+
+
+INTRCLASS(BenchA);
+DECLCLASS(BenchA){
+    Obj obj;
+    int n;
+};
+
+INTRCLASS(BenchB);
+DECLCLASS(BenchB){
+    BenchA a;
+};
+
+INTRCLASS(BenchC);
+DECLCLASS(BenchC){
+    BenchB b;
+};
+
+
+static void bench_fun(BenchA *a)
+{
+    CALL_DYN(bench_fun, a, (a));
+}
+
+
+/* The ancestor walk CALL_DYN replaced, for comparison. */
+static void bench_fun_lookup(BenchA *a)
+{
+    bool funnotfound;
+    ((void (*)(BenchA*))lookup_dynfun((Obj*)a, (DynFun*)bench_fun,
+                                      &funnotfound))(a);
+}
+
+
+static void benchA_fun(BenchA *a)
+{
+    a->n++;
+}
+
+
+static bool benchA_init(BenchA *a)
+{
+    a->n=0;
+    return TRUE;
+}
+
+
+static BenchA *create_benchA()
+{
+    CREATEOBJ_IMPL(BenchA, benchA, (p));
+}
+
+
+static void benchA_deinit(BenchA *UNUSED(a))
+{
+}
+
+
+static void bench_watch_handler(Watch *UNUSED(watch), Obj *UNUSED(obj))
+{
+}
+
+
+/* Dummy dynfuns so that the handler tables have realistic sizes. */
+#define DUMMY(N) static void dummy##N(Obj *UNUSED(o)){}
+DUMMY(0) DUMMY(1) DUMMY(2) DUMMY(3) DUMMY(4) DUMMY(5) DUMMY(6) DUMMY(7)
+
+
+static DynFunTab benchA_dynfuntab[]={
+    {(DynFun*)dummy0, (DynFun*)dummy0},
+    {(DynFun*)dummy1, (DynFun*)dummy1},
+    {(DynFun*)bench_fun, (DynFun*)benchA_fun},
+    {(DynFun*)dummy2, (DynFun*)dummy2},
+    {(DynFun*)dummy3, (DynFun*)dummy3},
+    END_DYNFUNTAB
+};
+
+static DynFunTab benchB_dynfuntab[]={
+    {(DynFun*)dummy4, (DynFun*)dummy4},
+    {(DynFun*)dummy5, (DynFun*)dummy5},
+    END_DYNFUNTAB
+};
+
+static DynFunTab benchC_dynfuntab[]={
+    {(DynFun*)dummy6, (DynFun*)dummy6},
+    {(DynFun*)dummy7, (DynFun*)dummy7},
+    END_DYNFUNTAB
+};
+
+
+IMPLCLASS(BenchA, Obj, benchA_deinit, benchA_dynfuntab);
+IMPLCLASS(BenchB, BenchA, NULL, benchB_dynfuntab);
+IMPLCLASS(BenchC, BenchB, NULL, benchC_dynfuntab);
+
+
+/*}}}*/
+
+
+/*{{{ Objects */
+
+
+static void bench_obj()
+{
+    BenchC c;
+    BenchA *a=(BenchA*)&c;
+    Watch watch=WATCH_INIT;
+
+    OBJ_INIT(&c, BenchC);
+
+    BENCH("obj/lookup_dynfun", OPS, bench_fun_lookup(a));
+    BENCH("obj/call_dyn", OPS, bench_fun(a));
+    BENCH("obj/is", OPS, bench_sink+=OBJ_IS(&c, BenchA));
+    BENCH("obj/cast", OPS, bench_sink+=(OBJ_CAST(a, BenchB)!=NULL));
+    BENCH("obj/is_str", OPS, bench_sink+=obj_is_str((Obj*)&c, "BenchA"));
+    BENCH("obj/create_destroy", OPS, destroy_obj((Obj*)create_benchA()));
+    BENCH("watch/setup_reset", OPS,
+          watch_setup(&watch, (Obj*)&c, bench_watch_handler);
+          watch_reset(&watch));
+}
+
+
+/*}}}*/
+
+
+/*{{{ Pointer maps */
+
+
+/* Keys are separately allocated blocks, like regions. */
+static void bench_maps(int n)
+{
+    void **keys=ALLOC_N(void*, n);
+    Rb_node rb=NULL;
+    PtrMap map=PTRMAP_INIT;
+    char name[32];
+    int i, f;
+
+    for(i=0; i<n; i++)
+        keys[i]=malloc(64+(i%7)*32);
+
+    sprintf(name, "rb/insert/%d", n);
+    BENCH_SETUP(name, n,
+                rb=make_rb(),
+                rb_insertp(rb, keys[bench_i], keys[bench_i]),
+                rb_free_tree(rb));
+
+    sprintf(name, "ptrmap/set/%d", n);
+    BENCH_SETUP(name, n,
+                (void)0,
+                ptrmap_set(&map, keys[bench_i], keys[bench_i]),
+                ptrmap_clear(&map));
+
+    rb=make_rb();
+    for(i=0; i<n; i++){
+        rb_insertp(rb, keys[i], keys[i]);
+        ptrmap_set(&map, keys[i], keys[i]);
+    }
+
+    sprintf(name, "rb/find/%d", n);
+    BENCH(name, OPS,
+          bench_sink+=(long)rb_find_pkey_n(rb, keys[(bench_i*7)%n], &f)->v.val);
+
+    sprintf(name, "ptrmap/get/%d", n);
+    BENCH(name, OPS,
+          bench_sink+=(long)ptrmap_get(&map, keys[(bench_i*7)%n]));
+
+    rb_free_tree(rb);
+    ptrmap_clear(&map);
+
+    sprintf(name, "rb/delete/%d", n);
+    BENCH_SETUP(name, n,
+                rb=make_rb();
+                for(i=0; i<n; i++) rb_insertp(rb, keys[i], keys[i]),
+                rb_delete_node(rb_find_pkey_n(rb, keys[bench_i], &f)),
+                rb_free_tree(rb));
+
+    sprintf(name, "ptrmap/remove/%d", n);
+    BENCH_SETUP(name, n,
+                for(i=0; i<n; i++) ptrmap_set(&map, keys[i], keys[i]),
+                ptrmap_remove(&map, keys[bench_i]),
+                ptrmap_clear(&map));
+
+    for(i=0; i<n; i++)
+        free(keys[i]);
+    free(keys);
+}
+
+
+/*}}}*/
+
+
+/*{{{ The stringstore */
+
+
+static void bench_stringstore()
+{
+    static char names[N][24];
+    StringId ids[N];
+    int i;
+
+    for(i=0; i<N; i++)
+        sprintf(names[i], "attr-%d-selected", i);
+
+    BENCH_SETUP("stringstore/alloc_new", N,
+                (void)0,
+                ids[bench_i]=stringstore_alloc(names[bench_i]),
+                for(i=0; i<N; i++) stringstore_free(ids[i]));
+
+    for(i=0; i<N; i++)
+        ids[i]=stringstore_alloc(names[i]);
+
+    BENCH("stringstore/alloc_existing", OPS,
+          stringstore_free(stringstore_alloc(names[(bench_i*7)%N])));
+    BENCH("stringstore/find", OPS,
+          bench_sink+=(stringstore_find(names[(bench_i*7)%N])!=NULL));
+    BENCH("stringstore/find_n", OPS,
+          bench_sink+=(stringstore_find_n(names[(bench_i*7)%N], 6)!=NULL));
+
+    for(i=0; i<N; i++)
+        stringstore_free(ids[i]);
+}
+
+
+/*}}}*/
+
+
+/*{{{ Lists */
+
+
+static void bench_lists()
+{
+    BenchA *objs=ALLOC_N(BenchA, N);
+    ObjList *objlist=NULL;
+    PtrList *ptrlist=NULL;
+    ObjVec objvec=OBJVEC_INIT;
+    PtrVec ptrvec=PTRVEC_INIT;
+    ObjListIterTmp otmp;
+    PtrListIterTmp ptmp;
+    ObjVecIterTmp ovtmp;
+    PtrVecIterTmp pvtmp;
+    Obj *o;
+    int i;
+
+    for(i=0; i<N; i++){
+        OBJ_INIT(&objs[i], BenchA);
+        objlist_insert_last(&objlist, (Obj*)&objs[i]);
+        ptrlist_insert_last(&ptrlist, &objs[i]);
+        objvec_insert_last(&objvec, (Obj*)&objs[i], NULL);
+        ptrvec_insert_last(&ptrvec, &objs[i], NULL);
+    }
+
+    BENCH("objlist/iter", TRAVERSALS,
+          FOR_ALL_ON_OBJLIST(Obj*, o, objlist, otmp) bench_sink++);
+    BENCH("ptrlist/iter", TRAVERSALS,
+          FOR_ALL_ON_PTRLIST(Obj*, o, ptrlist, ptmp) bench_sink++);
+    BENCH("objvec/iter", TRAVERSALS,
+          FOR_ALL_ON_OBJVEC(Obj*, o, &objvec, ovtmp) bench_sink++);
+    BENCH("ptrvec/iter", TRAVERSALS,
+          FOR_ALL_ON_PTRVEC(Obj*, o, &ptrvec, pvtmp) bench_sink++);
+
+    BENCH("objlist/insert_remove", OPS,
+          objlist_insert_first(&objlist, (Obj*)&objs[bench_i%N]);
+          objlist_take_first(&objlist));
+    BENCH("objvec/insert_remove", OPS,
+          objvec_insert_first(&objvec, (Obj*)&objs[bench_i%N], NULL);
+          objvec_take_first(&objvec));
+
+    BENCH("slab/alloc_free", OPS, slab_free(slab_alloc(48)));
+
+    objlist_clear(&objlist);
+    ptrlist_clear(&ptrlist);
+    objvec_clear(&objvec);
+    ptrvec_clear(&ptrvec);
+    free(objs);
+}
+
+
+/*}}}*/
+
+
+/*{{{ UTF-8 */
+
+
+static int naive_len(const char *p, int n)
+{
+    int i, len=0;
+
+    for(i=0; i<n; i++){
+        if((p[i]&0xC0)!=0x80)
+            len++;
+    }
+
+    return len;
+}
+
+
+static int mb_len(const char *p, int n)
+{
+    mbstate_t ps;
+    int len=0, l;
+
+    memset(&ps, 0, sizeof(ps));
+
+    while(n>0){
+        l=mbrlen(p, n, &ps);
+        if(l<=0)
+            break;
+        len++;
+        n-=l;
+        p+=l;
+    }
+
+    return len;
+}
+
+
+/* Repeat whole copies of 'pat' and pad with ASCII, so that the result
+ * stays valid UTF-8.
+ */
+static void fill(char *buf, int n, const char *pat)
+{
+    int i=0, l=strlen(pat);
+
+    for(; i+l<=n; i+=l)
+        memcpy(buf+i, pat, l);
+    for(; i<n; i++)
+        buf[i]='x';
+    buf[n]='\0';
+}
+
+
+static void bench_utf8(const char *what, const char *pat, int n)
+{
+    char *buf=ALLOC_N(char, n+1);
+    char name[48];
+    long ops=OPS*16L/n;
+
+    if(buf==NULL)
+        return;
+
+    fill(buf, n, pat);
+
+    sprintf(name, "utf8/%s/len/%d", what, n);
+    BENCH(name, ops, bench_sink+=utf8_len(buf, n));
+    sprintf(name, "utf8/%s/naive_len/%d", what, n);
+    BENCH(name, ops, bench_sink+=naive_len(buf, n));
+    sprintf(name, "utf8/%s/mbrlen/%d", what, n);
+    BENCH(name, ops, bench_sink+=mb_len(buf, n));
+    sprintf(name, "utf8/%s/is_ascii/%d", what, n);
+    BENCH(name, ops, bench_sink+=utf8_is_ascii(buf, n));
+    sprintf(name, "utf8/%s/validate/%d", what, n);
+    BENCH(name, ops, bench_sink+=utf8_validate(buf, n));
+    sprintf(name, "utf8/%s/offset/%d", what, n);
+    BENCH(name, ops, bench_sink+=utf8_offset(buf, n, n/4));
+
+    free(buf);
+}
+
+
+/*}}}*/
+
+
+int main()
+{
+    static const int mapsizes[]={16, 128, 1024, 8192};
+    static const int strsizes[]={16, 64, 256, 4096};
+    unsigned int i;
+
+    if(setlocale(LC_CTYPE, "C.UTF-8")==NULL)
+        setlocale(LC_CTYPE, "");
+
+    bench_header();
+
+    bench_obj();
+    for(i=0; i<sizeof(mapsizes)/sizeof(mapsizes[0]); i++)
+        bench_maps(mapsizes[i]);
+    bench_stringstore();
+    bench_lists();
+    for(i=0; i<sizeof(strsizes)/sizeof(strsizes[0]); i++){
+        bench_utf8("ascii", "Terminal - user@host: ~/src", strsizes[i]);
+        bench_utf8("mixed",
+                   "Tyo\xcc\x88kalu \xe2\x82\xac 5 \xe6\x97\xa5\xe6\x9c\xac",
+                   strsizes[i]);
+    }
+
+    return 0;
+}
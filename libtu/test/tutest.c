@@ -8,10 +8,18 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "../misc.h"
 #include "../tokenizer.h"
 #include "../util.h"
+#include "../utf8.h"
+#include "../slab.h"
+#include "../ptrmap.h"
+#include "../stringstore.h"
+#include "../ptrvec.h"
+#include "../objvec.h"
+#include "../objp.h"
 
 int test_get_token() {
     Tokenizer*tokz;
@@ -91,6 +99,422 @@ int test_get_token() {
     return 0;
 }
 
+static int naive_utf8_len(const char *p, int n)
+{
+    int i, len=0;
+
+    for(i=0; i<n; i++){
+        if((p[i]&0xC0)!=0x80)
+            len++;
+    }
+
+    return len;
+}
+
+
+int test_utf8() {
+    char buf[300];
+    const char *mix="a\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80z";
+    int i, n;
+
+    /* Lengths across vector boundaries and tails */
+    for(n=0; n<(int)sizeof(buf); n++){
+        for(i=0; i<n; i++)
+            buf[i]=mix[i%12];
+        if(utf8_len(buf, n)!=naive_utf8_len(buf, n))
+            return 10;
+    }
+
+    n=strlen(mix);
+    if(utf8_len(mix, n)!=5)
+        return 11;
+    if(utf8_offset(mix, n, 0)!=0 || utf8_offset(mix, n, 2)!=3
+       || utf8_offset(mix, n, 4)!=10 || utf8_offset(mix, n, 9)!=n)
+        return 12;
+    if(utf8_nextoff(mix, 3)!=3 || utf8_prevoff(mix, 10)!=4)
+        return 13;
+
+    memset(buf, 'x', sizeof(buf));
+    if(!utf8_is_ascii(buf, sizeof(buf)))
+        return 20;
+    buf[sizeof(buf)-1]=(char)0xc3;
+    if(utf8_is_ascii(buf, sizeof(buf)))
+        return 21;
+
+    if(!utf8_validate(mix, n))
+        return 30;
+    if(utf8_validate(buf, sizeof(buf)))
+        return 31;
+    if(utf8_validate("\xc0\x80", 2) || utf8_validate("\xed\xa0\x80", 3)
+       || utf8_validate("\xf4\x90\x80\x80", 4) || utf8_validate("\x80", 1))
+        return 32;
+
+    return 0;
+}
+
+static int slab_live(size_t size)
+{
+    SlabStats st;
+    int i;
+
+    for(i=0; i<slab_nclasses(); i++){
+        if(slab_get_stats(i, &st) && st.size>=size)
+            return st.live;
+    }
+
+    return -1;
+}
+
+
+int test_slab() {
+    static char *p[5000];
+    int i, j;
+
+    /* Enough objects to need several slabs */
+    for(i=0; i<5000; i++){
+        p[i]=slab_alloc(40);
+        if(p[i]==NULL)
+            return 10;
+        for(j=0; j<40; j++){
+            if(p[i][j]!=0)
+                return 11;
+        }
+        memset(p[i], 0xff, 40);
+    }
+
+    if(slab_live(40)!=5000)
+        return 20;
+
+    for(i=0; i<5000; i+=2)
+        slab_free(p[i]);
+
+    if(slab_live(40)!=2500)
+        return 21;
+
+    /* Freed objects are reused, zeroed */
+    for(i=0; i<5000; i+=2){
+        p[i]=slab_alloc(33);
+        if(p[i]==NULL || p[i][0]!=0 || p[i][32]!=0)
+            return 30;
+    }
+
+    for(i=0; i<5000; i++)
+        slab_free(p[i]);
+
+    if(slab_live(40)!=0)
+        return 40;
+
+    if(slab_alloc(SLAB_MAX_SIZE+1)!=NULL)
+        return 50;
+
+    return 0;
+}
+
+int test_ptrmap() {
+    static int keys[1000];
+    PtrMap map=PTRMAP_INIT;
+    PtrMapIterTmp tmp;
+    int *v;
+    int i, n;
+
+    for(i=0; i<1000; i++){
+        if(!ptrmap_set(&map, &keys[i], &keys[(i+1)%1000]))
+            return 10;
+    }
+
+    if(PTRMAP_COUNT(&map)!=1000)
+        return 11;
+
+    for(i=0; i<1000; i++){
+        if(ptrmap_get(&map, &keys[i])!=&keys[(i+1)%1000])
+            return 12;
+    }
+
+    /* Remove every other entry while iterating */
+    n=0;
+    FOR_ALL_ON_PTRMAP(int*, v, &map, tmp){
+        int k=(const int*)tmp.key-keys;
+        if(v!=&keys[(k+1)%1000])
+            return 20;
+        if(k%2==0)
+            ptrmap_remove(&map, tmp.key);
+        n++;
+    }
+
+    if(n!=1000 || PTRMAP_COUNT(&map)!=500)
+        return 21;
+
+    for(i=0; i<1000; i++){
+        if((ptrmap_get(&map, &keys[i])!=NULL)!=(i%2==1))
+            return 22;
+    }
+
+    /* Setting NULL removes; reinsertion reuses tombstones */
+    ptrmap_set(&map, &keys[1], NULL);
+    if(ptrmap_get(&map, &keys[1])!=NULL || PTRMAP_COUNT(&map)!=499)
+        return 30;
+    for(i=0; i<1000; i+=2)
+        ptrmap_set(&map, &keys[i], &keys[i]);
+    if(PTRMAP_COUNT(&map)!=999 || ptrmap_get(&map, &keys[998])!=&keys[998])
+        return 31;
+
+    ptrmap_clear(&map);
+    if(ptrmap_get(&map, &keys[3])!=NULL)
+        return 40;
+
+    return 0;
+}
+
+int test_stringstore() {
+    static const char buf[]="frame-tiled-alt";
+    StringId a, b, c;
+    char name[32];
+    StringId ids[500];
+    int i;
+
+    a=stringstore_alloc("frame");
+    if(a==STRINGID_NONE || strcmp(stringstore_get(a), "frame")!=0)
+        return 10;
+
+    /* Not NUL-terminated */
+    b=stringstore_alloc_n(buf, 5);
+    if(b!=a)
+        return 11;
+    if(stringstore_find_n(buf, 11)!=STRINGID_NONE)
+        return 12;
+    c=stringstore_alloc_n(buf, 11);
+    if(c==STRINGID_NONE || strcmp(stringstore_get(c), "frame-tiled")!=0)
+        return 13;
+    if(stringstore_find("frame-tiled")!=c)
+        return 14;
+
+    /* Two references to "frame" */
+    stringstore_free(a);
+    if(stringstore_find("frame")!=a)
+        return 20;
+    stringstore_free(b);
+    if(stringstore_find("frame")!=STRINGID_NONE)
+        return 21;
+
+    /* Ids stay valid while the table grows */
+    for(i=0; i<500; i++){
+        sprintf(name, "attr%d", i);
+        ids[i]=stringstore_alloc(name);
+    }
+    if(stringstore_find("frame-tiled")!=c)
+        return 30;
+    for(i=0; i<500; i++){
+        sprintf(name, "attr%d", i);
+        if(stringstore_find(name)!=ids[i]
+           || strcmp(stringstore_get(ids[i]), name)!=0){
+            return 31;
+        }
+    }
+    for(i=0; i<500; i++)
+        stringstore_free(ids[i]);
+    if(stringstore_find("attr7")!=STRINGID_NONE)
+        return 32;
+
+    stringstore_ref(c);
+    stringstore_free(c);
+    if(stringstore_find("frame-tiled")!=c)
+        return 40;
+    stringstore_free(c);
+    if(stringstore_find("frame-tiled")!=STRINGID_NONE)
+        return 41;
+
+    stringstore_deinit();
+
+    return 0;
+}
+
+int test_ptrvec() {
+    static int items[100];
+    PtrVec vec=PTRVEC_INIT;
+    PtrVecIterTmp tmp;
+    VecHandle h[100], stale;
+    int *p;
+    int i, n;
+
+    /* 50..99 appended, 49..0 prepended */
+    for(i=50; i<100; i++){
+        if(!ptrvec_insert_last(&vec, &items[i], &h[i]))
+            return 10;
+    }
+    for(i=49; i>=0; i--){
+        if(!ptrvec_insert_first(&vec, &items[i], &h[i]))
+            return 11;
+    }
+
+    if(PTRVEC_COUNT(&vec)!=100)
+        return 12;
+    if(PTRVEC_FIRST(int*, &vec)!=&items[0] || PTRVEC_LAST(int*, &vec)!=&items[99])
+        return 13;
+
+    i=0;
+    FOR_ALL_ON_PTRVEC(int*, p, &vec, tmp){
+        if(p!=&items[i++])
+            return 14;
+    }
+    if(i!=100)
+        return 15;
+
+    /* Remove odd elements by handle while iterating backwards */
+    i=99;
+    FOR_ALL_ON_PTRVEC_REV(int*, p, &vec, tmp){
+        if(p!=&items[i])
+            return 20;
+        if(i%2==1 && ptrvec_remove_handle(&vec, h[i])!=p)
+            return 21;
+        i--;
+    }
+    if(PTRVEC_COUNT(&vec)!=50 || PTRVEC_LAST(int*, &vec)!=&items[98])
+        return 22;
+
+    /* Stale handles are detected, also after slot reuse */
+    stale=h[1];
+    if(ptrvec_get(&vec, stale)!=NULL || ptrvec_remove_handle(&vec, stale)!=NULL)
+        return 30;
+    ptrvec_insert_last(&vec, &items[1], &h[1]);
+    if(ptrvec_get(&vec, stale)!=NULL || ptrvec_get(&vec, h[1])!=&items[1])
+        return 31;
+
+    /* Reinsertion keeps handles */
+    if(!ptrvec_reinsert_first(&vec, &items[1]) || !ptrvec_reinsert_last(&vec, &items[0]))
+        return 40;
+    if(PTRVEC_FIRST(int*, &vec)!=&items[1] || PTRVEC_LAST(int*, &vec)!=&items[0])
+        return 41;
+    if(ptrvec_get(&vec, h[1])!=&items[1] || ptrvec_get(&vec, h[0])!=&items[0])
+        return 42;
+    for(i=2; i<100; i+=2){
+        if(ptrvec_get(&vec, h[i])!=&items[i])
+            return 43;
+    }
+
+    if(!ptrvec_remove(&vec, &items[50]) || ptrvec_contains(&vec, &items[50]))
+        return 50;
+    if(ptrvec_take_first(&vec)!=&items[1] || ptrvec_take_last(&vec)!=&items[0])
+        return 51;
+
+    n=0;
+    FOR_ALL_ON_PTRVEC(int*, p, &vec, tmp)
+        n++;
+    if(n!=48 || PTRVEC_COUNT(&vec)!=48)
+        return 52;
+
+    ptrvec_clear(&vec);
+    if(!PTRVEC_EMPTY(&vec) || ptrvec_take_first(&vec)!=NULL)
+        return 60;
+
+    return 0;
+}
+
+int test_objvec() {
+    ObjVec ov=OBJVEC_INIT;
+    ObjVecIterTmp tmp;
+    Obj *objs[10], *o;
+    VecHandle h;
+    int i;
+
+    for(i=0; i<10; i++){
+        objs[i]=ALLOC(Obj);
+        OBJ_INIT(objs[i], Obj);
+        if(!objvec_insert_last(&ov, objs[i], (i==5 ? &h : NULL)))
+            return 10;
+    }
+
+    /* Destroyed objects drop off the vector, also while iterating */
+    i=0;
+    FOR_ALL_ON_OBJVEC(Obj*, o, &ov, tmp){
+        if(o!=objs[i])
+            return 20;
+        if(i==3)
+            destroy_obj(objs[4]);
+        i+=(i==3 ? 2 : 1);
+    }
+    if(i!=10 || OBJVEC_COUNT(&ov)!=9)
+        return 21;
+
+    destroy_obj(objs[5]);
+    if(objvec_get(&ov, h)!=NULL || OBJVEC_COUNT(&ov)!=8)
+        return 22;
+
+    if(!objvec_remove(&ov, objs[0]) || objvec_contains(&ov, objs[0]))
+        return 30;
+    destroy_obj(objs[0]);
+
+    if(objvec_take_last(&ov)!=objs[9])
+        return 31;
+    destroy_obj(objs[9]);
+
+    objvec_clear(&ov);
+    for(i=1; i<9; i++){
+        if(i!=4 && i!=5)
+            destroy_obj(objs[i]);
+    }
+
+    return 0;
+}
+
+INTRCLASS(DynTest);
+DECLCLASS(DynTest){
+    Obj obj;
+    int n;
+};
+
+static int dyntest_fun(DynTest *d)
+{
+    int ret=-1;
+    CALL_DYN_RET(ret, int, dyntest_fun, d, (d));
+    return ret;
+}
+
+static int dyntest_missing(DynTest *d)
+{
+    int ret=-1;
+    CALL_DYN_RET(ret, int, dyntest_missing, d, (d));
+    return ret;
+}
+
+static int dyntest_fun_impl(DynTest *d)
+{
+    return ++d->n;
+}
+
+static DynFunTab dyntest_dynfuntab[]={
+    {(DynFun*)dyntest_fun, (DynFun*)dyntest_fun_impl},
+    END_DYNFUNTAB
+};
+
+IMPLCLASS(DynTest, Obj, NULL, dyntest_dynfuntab);
+
+int test_dynfun() {
+    DynTest *d=ALLOC(DynTest);
+
+    if(d==NULL)
+        return 1;
+    OBJ_INIT(d, DynTest);
+    d->n=0;
+
+    if(dyntest_fun(d)!=1 || dyntest_missing(d)!=-1)
+        return 10;
+    if(CLASSDESCR(DynTest).dispatch==NULL)
+        return 11;
+
+    /* Flushing drops the tables; call sites refill them */
+    flush_dynfun_dispatch();
+    if(CLASSDESCR(DynTest).dispatch!=NULL)
+        return 20;
+    if(dyntest_fun(d)!=2 || dyntest_missing(d)!=-1)
+        return 21;
+    if(dyntest_fun(d)!=3)
+        return 22;
+
+    destroy_obj((Obj*)d);
+
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     fprintf(stdout, "[TESTING] libtu ====\n");
@@ -108,6 +532,68 @@ int main(int argc, char *argv[])
         fprintf(stdout, "[OK]\n");
     }
 
+    fprintf(stdout, "[TEST] test_utf8: ");
+    result = test_utf8();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_slab: ");
+    result = test_slab();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_ptrmap: ");
+    result = test_ptrmap();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_stringstore: ");
+    result = test_stringstore();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_ptrvec: ");
+    result = test_ptrvec();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
+    fprintf(stdout, "[TEST] test_objvec: ");
+    result = test_objvec();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+    fprintf(stdout, "[TEST] test_dynfun: ");
+    result = test_dynfun();
+    if (result != 0) {
+        fprintf(stdout, "[ERROR]: %d\n", result);
+        err += 1;
+    } else {
+        fprintf(stdout, "[OK]\n");
+    }
+
     return err;
 }
 
@@ -0,0 +1,301 @@
+/*
+ * libtu/utf8.c
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#include "utf8.h"
+
+#if defined(__AVX2__)
+#define UTF8_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define UTF8_SSE2
+#include <emmintrin.h>
+#endif
+
+
+#define IS_CONT(C) (((C)&0xC0)==0x80)
+
+
+/*{{{ Vector helpers */
+
+
+/* Lead bytes are those that are not continuation bytes 0x80..0xBF, i.e.
+ * as signed chars those greater than (char)0xBF. Per-lane counts are
+ * accumulated in bytes and summed with psadbw before they can overflow.
+ */
+
+#ifdef UTF8_AVX2
+
+#define VEC_W 32
+
+static int vec_count_leads(const char *p, int nvec)
+{
+    const __m256i cont=_mm256_set1_epi8((char)0xBF);
+    const __m256i zero=_mm256_setzero_si256();
+    int len=0;
+
+    while(nvec>0){
+        __m256i acc=_mm256_setzero_si256();
+        __m128i s;
+        int k;
+
+        for(k=0; k<255 && nvec>0; k++, nvec--, p+=VEC_W){
+            __m256i v=_mm256_loadu_si256((const __m256i*)p);
+            acc=_mm256_sub_epi8(acc, _mm256_cmpgt_epi8(v, cont));
+        }
+
+        acc=_mm256_sad_epu8(acc, zero);
+        s=_mm_add_epi64(_mm256_castsi256_si128(acc),
+                        _mm256_extracti128_si256(acc, 1));
+        len+=_mm_cvtsi128_si32(s)+_mm_cvtsi128_si32(_mm_srli_si128(s, 8));
+    }
+
+    return len;
+}
+
+
+static bool vec_has_high(const char *p)
+{
+    __m256i v=_mm256_loadu_si256((const __m256i*)p);
+    return (_mm256_movemask_epi8(v)!=0);
+}
+
+#elif defined(UTF8_SSE2)
+
+#define VEC_W 16
+
+static int vec_count_leads(const char *p, int nvec)
+{
+    const __m128i cont=_mm_set1_epi8((char)0xBF);
+    const __m128i zero=_mm_setzero_si128();
+    int len=0;
+
+    while(nvec>0){
+        __m128i acc=_mm_setzero_si128();
+        int k;
+
+        for(k=0; k<255 && nvec>0; k++, nvec--, p+=VEC_W){
+            __m128i v=_mm_loadu_si128((const __m128i*)p);
+            acc=_mm_sub_epi8(acc, _mm_cmpgt_epi8(v, cont));
+        }
+
+        acc=_mm_sad_epu8(acc, zero);
+        len+=_mm_cvtsi128_si32(acc)+_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+    }
+
+    return len;
+}
+
+
+static bool vec_has_high(const char *p)
+{
+    __m128i v=_mm_loadu_si128((const __m128i*)p);
+    return (_mm_movemask_epi8(v)!=0);
+}
+
+#else
+
+/* Portable fallback in plain C. */
+
+#define VEC_W 8
+
+static int vec_count_leads(const char *p, int nvec)
+{
+    int len=0, i;
+
+    while(nvec>0){
+        for(i=0; i<VEC_W; i++)
+            len+=!IS_CONT(p[i]);
+        p+=VEC_W;
+        nvec--;
+    }
+
+    return len;
+}
+
+
+static bool vec_has_high(const char *p)
+{
+    int i;
+    unsigned char c=0;
+
+    for(i=0; i<VEC_W; i++)
+        c|=(unsigned char)p[i];
+
+    return ((c&0x80)!=0);
+}
+
+#endif
+
+
+/*}}}*/
+
+
+/*{{{ Counting and scanning */
+
+
+/* Number of characters in the 'n' first bytes of 'p'. Stray
+ * continuation bytes are not counted.
+ */
+int utf8_len(const char *p, int n)
+{
+    int nvec=n/VEC_W;
+    int len=vec_count_leads(p, nvec);
+    int i;
+
+    for(i=nvec*VEC_W; i<n; i++)
+        len+=!IS_CONT(p[i]);
+
+    return len;
+}
+
+
+bool utf8_is_ascii(const char *p, int n)
+{
+    int i=0;
+
+    for(; i+VEC_W<=n; i+=VEC_W){
+        if(vec_has_high(p+i))
+            return FALSE;
+    }
+
+    for(; i<n; i++){
+        if(p[i]&0x80)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/* Byte offset of character number 'nchars' (counting from zero), or 'n'
+ * if the string is shorter.
+ */
+int utf8_offset(const char *p, int n, int nchars)
+{
+    int i=0;
+
+    while(i+VEC_W<=n){
+        int cnt=vec_count_leads(p+i, 1);
+        if(cnt>nchars)
+            break;
+        nchars-=cnt;
+        i+=VEC_W;
+    }
+
+    for(; i<n; i++){
+        if(!IS_CONT(p[i])){
+            if(nchars==0)
+                return i;
+            nchars--;
+        }
+    }
+
+    return n;
+}
+
+
+int utf8_nextoff(const char *p, int opos)
+{
+    int pos=opos;
+
+    while(p[pos]){
+        pos++;
+        if(!IS_CONT(p[pos]))
+            break;
+    }
+
+    return pos-opos;
+}
+
+
+int utf8_prevoff(const char *p, int opos)
+{
+    int pos=opos;
+
+    while(pos>0){
+        pos--;
+        if(!IS_CONT(p[pos]))
+            break;
+    }
+
+    return opos-pos;
+}
+
+
+/*}}}*/
+
+
+/*{{{ Validation */
+
+
+/* Validate a sequence starting at a non-ASCII byte and return its
+ * length, or 0 if it is malformed, overlong, a surrogate or beyond
+ * U+10FFFF.
+ */
+static int validate_seq(const unsigned char *s, int left)
+{
+    unsigned char c=s[0];
+
+    if(c>=0xC2 && c<=0xDF){
+        if(left<2 || !IS_CONT(s[1]))
+            return 0;
+        return 2;
+    }
+
+    if(c>=0xE0 && c<=0xEF){
+        if(left<3 || !IS_CONT(s[1]) || !IS_CONT(s[2]))
+            return 0;
+        if(c==0xE0 && s[1]<0xA0)
+            return 0;
+        if(c==0xED && s[1]>=0xA0)
+            return 0;
+        return 3;
+    }
+
+    if(c>=0xF0 && c<=0xF4){
+        if(left<4 || !IS_CONT(s[1]) || !IS_CONT(s[2]) || !IS_CONT(s[3]))
+            return 0;
+        if(c==0xF0 && s[1]<0x90)
+            return 0;
+        if(c==0xF4 && s[1]>=0x90)
+            return 0;
+        return 4;
+    }
+
+    return 0;
+}
+
+
+bool utf8_validate(const char *p, int n)
+{
+    const unsigned char *s=(const unsigned char*)p;
+    int i=0;
+
+    while(i<n){
+        int l;
+
+        if(i+VEC_W<=n && !vec_has_high(p+i)){
+            i+=VEC_W;
+            continue;
+        }
+
+        if(s[i]<0x80){
+            i++;
+            continue;
+        }
+
+        l=validate_seq(s+i, n-i);
+        if(l==0)
+            return FALSE;
+        i+=l;
+    }
+
+    return TRUE;
+}
+
+
+/*}}}*/
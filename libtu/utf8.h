@@ -0,0 +1,24 @@
+/*
+ * libtu/utf8.h
+ *
+ * You may distribute and modify this library under the terms of either
+ * the Clarified Artistic License or the GNU LGPL, version 2.1 or later.
+ */
+
+#ifndef LIBTU_UTF8_H
+#define LIBTU_UTF8_H
+
+#include "types.h"
+
+/* All lengths and offsets are in bytes except for the return value of
+ * utf8_len, which counts characters (lead bytes).
+ */
+
+extern int utf8_len(const char *p, int n);
+extern bool utf8_is_ascii(const char *p, int n);
+extern bool utf8_validate(const char *p, int n);
+extern int utf8_offset(const char *p, int n, int nchars);
+extern int utf8_nextoff(const char *p, int pos);
+extern int utf8_prevoff(const char *p, int pos);
+
+#endif /* LIBTU_UTF8_H */
@@ -50,13 +50,7 @@ static int getbeg(GrBrush *brush, int maxw, char *str, int *wret)
 
     if(fnte.max_width!=0){
         /* Do an initial skip. */
-        int n2=maxw/fnte.max_width;
-
-        n=0;
-        while(n2>0){
-            n+=str_nextoff(str, n);
-            n2--;
-        }
+        n=str_offset(str, maxw/fnte.max_width);
     }
 
     w=grbrush_get_text_width(brush, str, n);
@@ -8,6 +8,7 @@
 
 #include <string.h>
 
+#include <libtu/minmax.h>
 #include <ioncore/common.h>
 #include <ioncore/mplex.h>
 #include "statusbar.h"
@@ -143,19 +144,31 @@ static void draw_elems(GrBrush *brush, WRectangle *g, int ty,
 }
 
 
-void statusbar_draw(WStatusBar *sb, bool complete)
+static void get_inner_geom(WStatusBar *sb, WRectangle *g, int *ty)
 {
-    WRectangle g;
     GrBorderWidths bdw;
     GrFontExtents fnte;
+
+    grbrush_get_border_widths(sb->brush, &bdw);
+    grbrush_get_font_extents(sb->brush, &fnte);
+
+    g->x=bdw.left;
+    g->y=bdw.top;
+    g->w=REGION_GEOM(sb).w-bdw.left-bdw.right;
+    g->h=REGION_GEOM(sb).h-bdw.top-bdw.bottom;
+
+    *ty=(g->y+fnte.baseline+(g->h-fnte.max_height)/2);
+}
+
+
+void statusbar_draw(WStatusBar *sb, bool complete)
+{
+    WRectangle g;
     int ty;
 
     if(sb->brush==NULL)
         return;
 
-    grbrush_get_border_widths(sb->brush, &bdw);
-    grbrush_get_font_extents(sb->brush, &fnte);
-
     g.x=0;
     g.y=0;
     g.w=REGION_GEOM(sb).w;
@@ -168,12 +181,7 @@ void statusbar_draw(WStatusBar *sb, bool complete)
     if(sb->elems==NULL)
         return;
 
-    g.x+=bdw.left;
-    g.w-=bdw.left+bdw.right;
-    g.y+=bdw.top;
-    g.h-=bdw.top+bdw.bottom;
-
-    ty=(g.y+fnte.baseline+(g.h-fnte.max_height)/2);
+    get_inner_geom(sb, &g, &ty);
 
     draw_elems(sb->brush, &g, ty, sb->elems, sb->nelems, TRUE);
 
@@ -181,3 +189,41 @@ void statusbar_draw(WStatusBar *sb, bool complete)
 }
 
 
+/* Redraw only the horizontal span [x, x+w) of the element area. */
+void statusbar_draw_partial(WStatusBar *sb, int x, int w)
+{
+    WRectangle g;
+    int ty, x1, i, first=-1, last=-1;
+
+    if(sb->brush==NULL || sb->elems==NULL)
+        return;
+
+    get_inner_geom(sb, &g, &ty);
+
+    x1=MINOF(x+w, g.x+g.w);
+    x=MAXOF(x, g.x);
+
+    if(x1<=x || g.h<=0)
+        return;
+
+    g.x=x;
+    g.w=x1-x;
+
+    for(i=0; i<sb->nelems; i++){
+        const WSBElem *el=&(sb->elems[i]);
+        if(el->x<x1 && el->x+el->text_w>x){
+            if(first<0)
+                first=i;
+            last=i;
+        }
+    }
+
+    grbrush_begin(sb->brush, &g, GRBRUSH_NO_CLEAR_OK|GRBRUSH_NEED_CLIP);
+
+    if(first<0)
+        grbrush_clear_area(sb->brush, &g);
+    else
+        draw_elems(sb->brush, &g, ty, sb->elems+first, last-first+1, TRUE);
+
+    grbrush_end(sb->brush);
+}
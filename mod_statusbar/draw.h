@@ -14,5 +14,6 @@
 
 extern void statusbar_draw(WStatusBar *sb, bool complete);
 extern void statusbar_calculate_xs(WStatusBar *sb);
+extern void statusbar_draw_partial(WStatusBar *sb, int x, int w);
 
 #endif /* ION_MOD_STATUSBAR_DRAW_H */
@@ -119,6 +119,9 @@ static void init_sbelem(WSBElem *el)
     el->zeropad=0;
     el->x=0;
     el->traywins=NULL;
+    el->rawtext=NULL;
+    el->hint_key=NULL;
+    el->stale=FALSE;
 }
 
 
@@ -163,7 +166,10 @@ static WSBElem *get_sbelems(ExtlTab t, int *nret, int *filleridxret)
                 if(el[i].type==WSBELEM_TEXT || el[i].type==WSBELEM_STRETCH){
                     extl_table_gets_s(tt, "text", &(el[i].text));
                 }else if(el[i].type==WSBELEM_METER){
-                    gets_stringstore(tt, "meter", &(el[i].meter));
+                    if(gets_stringstore(tt, "meter", &(el[i].meter))){
+                        el[i].hint_key=scat(stringstore_get(el[i].meter),
+                                            "_hint");
+                    }
                     extl_table_gets_s(tt, "tmpl", &(el[i].tmpl));
                     extl_table_gets_i(tt, "align", &(el[i].align));
                     extl_table_gets_i(tt, "zeropad", &(el[i].zeropad));
@@ -211,6 +217,10 @@ static void free_sbelems(WSBElem *el, int n)
             free(el[i].text);
         if(el[i].tmpl!=NULL)
             free(el[i].tmpl);
+        if(el[i].rawtext!=NULL)
+            free(el[i].rawtext);
+        if(el[i].hint_key!=NULL)
+            free(el[i].hint_key);
         if(el[i].meter!=STRINGID_NONE)
             stringstore_free(el[i].meter);
         if(el[i].attr!=STRINGID_NONE)
@@ -846,6 +856,116 @@ static void statusbar_rearrange(WStatusBar *sb, bool rs)
 
 
 
+static bool str_same(const char *a, const char *b)
+{
+    if(a==NULL || b==NULL)
+        return (a==b);
+    return (strcmp(a, b)==0);
+}
+
+
+/* Does the new value and hint of meter element differ from the
+ * previous ones?
+ */
+static bool meter_changed(WSBElem *el, const char *text, const char *hint)
+{
+    return (el->stale
+            || !str_same(el->rawtext, text)
+            || !str_same(stringstore_get(el->attr), hint));
+}
+
+
+/* Set the value of a meter element; takes ownership of 'text'. */
+static void set_meter(WStatusBar *sb, WSBElem *el, char *text,
+                      const char *hint)
+{
+    const char *str;
+
+    if(el->text!=NULL){
+        free(el->text);
+        el->text=NULL;
+    }
+
+    if(el->rawtext!=NULL)
+        free(el->rawtext);
+    el->rawtext=text;
+    el->stale=FALSE;
+
+    if(text!=NULL){
+        /* Zero-pad */
+        int l=strlen(text);
+        int ml=str_len(text);
+        int diff=MAXOF(el->zeropad-ml, 0);
+        el->text=ALLOC_N(char, l+diff+1);
+        if(el->text!=NULL){
+            memset(el->text, '0', diff);
+            memcpy(el->text+diff, text, l+1);
+        }
+    }
+
+    if(el->tmpl!=NULL && el->text!=NULL){
+        char *tmp=grbrush_make_label(sb->brush, el->text, el->max_w);
+        if(tmp!=NULL){
+            free(el->text);
+            el->text=tmp;
+        }
+    }
+
+    str=(el->text!=NULL ? el->text : STATUSBAR_NX_STR);
+
+    el->text_w=grbrush_get_text_width(sb->brush, str, strlen(str));
+
+    if(!str_same(stringstore_get(el->attr), hint)){
+        if(el->attr!=GRATTR_NONE){
+            stringstore_free(el->attr);
+            el->attr=GRATTR_NONE;
+        }
+        if(hint!=NULL)
+            el->attr=stringstore_alloc(hint);
+    }
+}
+
+
+static void damage(int *x0, int *x1, int x, int w)
+{
+    *x0=MINOF(*x0, x);
+    *x1=MAXOF(*x1, x+w);
+}
+
+
+/* Recalculate element positions after widths changed and extend the
+ * damaged span by all elements that moved or changed in size.
+ */
+static void relayout_damage(WStatusBar *sb, const int *old_w,
+                            int *x0, int *x1)
+{
+    int *old_x=ALLOC_N(int, sb->nelems);
+    int i;
+
+    if(old_x==NULL){
+        statusbar_rearrange(sb, FALSE);
+        *x0=INT_MIN/2;
+        *x1=INT_MAX/2;
+        return;
+    }
+
+    for(i=0; i<sb->nelems; i++)
+        old_x[i]=sb->elems[i].x;
+
+    statusbar_rearrange(sb, FALSE);
+
+    for(i=0; i<sb->nelems; i++){
+        WSBElem *el=&(sb->elems[i]);
+        if(old_x[i]!=el->x || old_w[i]!=el->text_w){
+            damage(x0, x1, old_x[i], old_w[i]);
+            damage(x0, x1, el->x, el->text_w);
+        }
+    }
+
+    free(old_x);
+}
+
+
 /*EXTL_DOC
  * Set statusbar template.
  */
@@ -855,86 +975,83 @@ void statusbar_update(WStatusBar *sb, ExtlTab t)
     int i;
     WSBElem *el;
     bool grow=FALSE;
+    int *old_w=NULL;
+    int x0=INT_MAX, x1=INT_MIN;
 
     if(sb->brush==NULL)
         return;
 
     for(i=0; i<sb->nelems; i++){
         const char *meter;
+        char *text=NULL, *hint=NULL;
 
         el=&(sb->elems[i]);
 
         if(el->type!=WSBELEM_METER)
             continue;
 
-        if(el->text!=NULL){
-            free(el->text);
-            el->text=NULL;
+        meter=stringstore_get(el->meter);
+
+        if(meter==NULL)
+            continue;
+
+        extl_table_gets_s(t, meter, &text);
+        if(el->hint_key!=NULL)
+            extl_table_gets_s(t, el->hint_key, &hint);
+
+        if(!meter_changed(el, text, hint)){
+            if(text!=NULL)
+                free(text);
+            if(hint!=NULL)
+                free(hint);
+            continue;
         }
 
-        if(el->attr!=GRATTR_NONE){
-            stringstore_free(el->attr);
-            el->attr=GRATTR_NONE;
+        if(old_w==NULL){
+            int j;
+            old_w=ALLOC_N(int, sb->nelems);
+            if(old_w!=NULL){
+                for(j=0; j<sb->nelems; j++)
+                    old_w[j]=sb->elems[j].text_w;
+            }
         }
 
-        meter=stringstore_get(el->meter);
+        set_meter(sb, el, text, hint);
 
-        if(meter!=NULL){
-            const char *str;
-            char *attrnm;
-
-            extl_table_gets_s(t, meter, &(el->text));
-
-            if(el->text==NULL){
-                str=STATUSBAR_NX_STR;
-            }else{
-                /* Zero-pad */
-                int l=strlen(el->text);
-                int ml=str_len(el->text);
-                int diff=el->zeropad-ml;
-                if(diff>0){
-                    char *tmp=ALLOC_N(char, l+diff+1);
-                    if(tmp!=NULL){
-                        memset(tmp, '0', diff);
-                        memcpy(tmp+diff, el->text, l+1);
-                        free(el->text);
-                        el->text=tmp;
-                    }
-                }
-                str=el->text;
-            }
+        if(hint!=NULL)
+            free(hint);
 
-            if(el->tmpl!=NULL && el->text!=NULL){
-                char *tmp=grbrush_make_label(sb->brush, el->text, el->max_w);
-                if(tmp!=NULL){
-                    free(el->text);
-                    el->text=tmp;
-                    str=tmp;
-                }
-            }
+        if(el->text_w>el->max_w && el->tmpl==NULL){
+            el->max_w=el->text_w;
+            grow=TRUE;
+        }
 
-            el->text_w=grbrush_get_text_width(sb->brush, str, strlen(str));
+        damage(&x0, &x1, el->x, el->text_w);
+        if(old_w!=NULL)
+            damage(&x0, &x1, el->x, old_w[i]);
+    }
 
-            if(el->text_w>el->max_w && el->tmpl==NULL){
-                el->max_w=el->text_w;
-                grow=TRUE;
-            }
+    if(x0>x1)
+        return;
 
-            attrnm=scat(meter, "_hint");
-            if(attrnm!=NULL){
-                char *s;
-                if(extl_table_gets_s(t, attrnm, &s)){
-                    el->attr=stringstore_alloc(s);
-                    free(s);
-                }
-                free(attrnm);
+    if(old_w==NULL || grow){
+        /* Natural size changed (or out of memory); lay out and
+         * redraw everything.
+         */
+        statusbar_rearrange(sb, grow);
+        window_draw((WWindow*)sb, FALSE);
+    }else{
+        for(i=0; i<sb->nelems; i++){
+            if(old_w[i]!=sb->elems[i].text_w){
+                relayout_damage(sb, old_w, &x0, &x1);
+                break;
             }
         }
+        statusbar_draw_partial(sb, x0, x1-x0);
     }
 
-    statusbar_rearrange(sb, grow);
-
-    window_draw((WWindow*)sb, FALSE);
+    if(old_w!=NULL)
+        free(old_w);
 }
 
 
@@ -947,6 +1064,7 @@ void statusbar_update(WStatusBar *sb, ExtlTab t)
 void statusbar_updategr(WStatusBar *p)
 {
     GrBrush *nbrush;
+    int i;
 
     nbrush=gr_get_brush(p->wwin.win, region_rootwin_of((WRegion*)p),
                         "stdisp-statusbar");
@@ -958,6 +1076,9 @@ void statusbar_updategr(WStatusBar *p)
 
     p->brush=nbrush;
 
+    for(i=0; i<p->nelems; i++)
+        p->elems[i].stale=TRUE;
+
     statusbar_calc_widths(p);
     statusbar_rearrange(p, TRUE);
 
@@ -52,6 +52,9 @@ DECLSTRUCT(WSBElem){
     int zeropad;
     int x;
     PtrList *traywins;
+    char *rawtext;
+    char *hint_key;
+    bool stale;
 };
 
 INTRCLASS(WStatusBar);
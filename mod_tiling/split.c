@@ -11,7 +11,7 @@
 #include <X11/Xmd.h>
 
 #include <libtu/minmax.h>
-#include <libtu/rb.h>
+#include <libtu/ptrmap.h>
 #include <libtu/objp.h>
 #include <ioncore/common.h>
 #include <ioncore/focus.h>
@@ -29,7 +29,7 @@
 #include "split-stdisp.h"
 
 
-static Rb_node split_of_map=NULL;
+static PtrMap split_of_map=PTRMAP_INIT;
 
 
 /*{{{ Geometry helper functions */
@@ -100,18 +100,9 @@ static void bound(int *what, int min, int max)
 
 WSplitRegion *splittree_node_of(WRegion *reg)
 {
-    Rb_node node=NULL;
-    int found=0;
-
     /*assert(REGION_MANAGER_CHK(reg, WTiling)!=NULL);*/
 
-    if(split_of_map!=NULL){
-        node=rb_find_pkey_n(split_of_map, reg, &found);
-        if(found)
-            return (WSplitRegion*)(node->v.val);
-    }
-
-    return NULL;
+    return (WSplitRegion*)ptrmap_get(&split_of_map, reg);
 }
 
 
@@ -120,24 +111,10 @@ WSplitRegion *splittree_node_of(WRegion *reg)
 
 bool splittree_set_node_of(WRegion *reg, WSplitRegion *split)
 {
-    Rb_node node=NULL;
-    int found;
-
     /*assert(REGION_MANAGER_CHK(reg, WTiling)!=NULL);*/
 
-    if(split_of_map==NULL){
-        if(split==NULL)
-            return TRUE;
-        split_of_map=make_rb();
-        if(split_of_map==NULL)
-            return FALSE;
-    }
-
-    node=rb_find_pkey_n(split_of_map, reg, &found);
-    if(found)
-        rb_delete_node(node);
-
-    return (rb_insertp(split_of_map, reg, split)!=NULL);
+    /* A NULL split removes the entry. */
+    return ptrmap_set(&split_of_map, reg, split);
 }
 
 
@@ -2289,15 +2266,13 @@ WRegion *splitregion_reg(WSplitRegion *node)
 
 ExtlTab split_base_config(WSplit *node)
 {
-    ExtlTab t=extl_create_table();
-    extl_table_sets_s(t, "type", OBJ_TYPESTR(node));
-    return t;
+    return extl_create_table_with("s", "type", OBJ_TYPESTR(node));
 }
 
 
 static bool splitregion_get_config(WSplitRegion *node, ExtlTab *ret)
 {
-    ExtlTab rt, t;
+    ExtlTab rt;
 
     if(node->reg==NULL)
         return FALSE;
@@ -2309,10 +2284,9 @@ static bool splitregion_get_config(WSplitRegion *node, ExtlTab *ret)
     }
 
     rt=region_get_configuration(node->reg);
-    t=split_base_config(&(node->split));
-    extl_table_sets_t(t, "regparams", rt);
+    *ret=extl_create_table_with("st", "type", OBJ_TYPESTR(node),
+                                "regparams", rt);
     extl_unref_table(rt);
-    *ret=t;
 
     return TRUE;
 }
@@ -2343,15 +2317,13 @@ static bool splitsplit_get_config(WSplitSplit *node, ExtlTab *ret)
     tls=split_size(node->tl, node->dir);
     brs=split_size(node->br, node->dir);
 
-    extl_table_sets_s(tab, "dir", (node->dir==SPLIT_VERTICAL
-                                   ? "vertical" : "horizontal"));
+    extl_table_sets_many(tab, "sitit",
+                         "dir", (node->dir==SPLIT_VERTICAL
+                                 ? "vertical" : "horizontal"),
+                         "tls", tls, "tl", tltab,
+                         "brs", brs, "br", brtab);
 
-    extl_table_sets_i(tab, "tls", tls);
-    extl_table_sets_t(tab, "tl", tltab);
     extl_unref_table(tltab);
-
-    extl_table_sets_i(tab, "brs", brs);
-    extl_table_sets_t(tab, "br", brtab);
     extl_unref_table(brtab);
 
     *ret=tab;
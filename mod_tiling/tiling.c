@@ -12,7 +12,7 @@
 
 #include <libtu/objp.h>
 #include <libtu/minmax.h>
-#include <libtu/ptrlist.h>
+#include <libtu/ptrvec.h>
 #include <libmainloop/defer.h>
 #include <libmainloop/signal.h>
 
@@ -478,7 +478,7 @@ bool tiling_managed_add_default(WTiling *ws, WRegion *reg)
     WFrame *frame;
 
     if(TILING_STDISP_OF(ws)!=reg){
-        if(!ptrlist_insert_last(&(ws->managed_list), reg))
+        if(!ptrvec_insert_last(&(ws->managed_list), reg, NULL))
             return FALSE;
     }
 
@@ -548,7 +548,7 @@ bool tiling_init(WTiling *ws, WWindow *parent, const WFitParams *fp,
                          ? create_frame_fn
                          : create_frame_tiling);
     ws->stdispnode=NULL;
-    ws->managed_list=NULL;
+    ptrvec_init(&(ws->managed_list));
     ws->batchop=FALSE;
 
     ws->dummywin=XCreateWindow(ioncore_g.dpy, parent->win,
@@ -625,6 +625,8 @@ void tiling_deinit(WTiling *ws)
         assert(FALSE);
     }
 
+    ptrvec_clear(&(ws->managed_list));
+
     if(ws->split_tree!=NULL)
         destroy_obj((Obj*)(ws->split_tree));
 
@@ -657,10 +659,10 @@ bool tiling_rescue_clientwins(WTiling *ws, WRescueInfo *info)
 {
     WTilingIterTmp tmp;
 
-    ptrlist_iter_init(&tmp, ws->managed_list);
+    ptrvec_iter_init(&tmp, &(ws->managed_list));
 
     return region_rescue_some_clientwins((WRegion*)ws, info,
-                                         (WRegionIterator*)ptrlist_iter,
+                                         (WRegionIterator*)ptrvec_iter,
                                          &tmp);
 }
 
@@ -670,7 +672,7 @@ void tiling_do_managed_remove(WTiling *ws, WRegion *reg)
     if(TILING_STDISP_OF(ws)==reg){
         ws->stdispnode->regnode.reg=NULL;
     }else{
-        ptrlist_remove(&(ws->managed_list), reg);
+        ptrvec_remove(&(ws->managed_list), reg);
     }
 
     region_unset_manager(reg, (WRegion*)ws);
@@ -1117,11 +1119,11 @@ EXTL_SAFE
 EXTL_EXPORT_MEMBER
 bool tiling_managed_i(WTiling *ws, ExtlFn iterfn)
 {
-    PtrListIterTmp tmp;
+    PtrVecIterTmp tmp;
 
-    ptrlist_iter_init(&tmp, ws->managed_list);
+    ptrvec_iter_init(&tmp, &(ws->managed_list));
 
-    return extl_iter_objlist_(iterfn, (ObjIterator*)ptrlist_iter, &tmp);
+    return extl_iter_objlist_(iterfn, (ObjIterator*)ptrvec_iter, &tmp);
 }
 
 
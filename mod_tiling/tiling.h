@@ -9,7 +9,7 @@
 #ifndef ION_MOD_TILING_TILING_H
 #define ION_MOD_TILING_TILING_H
 
-#include <libtu/ptrlist.h>
+#include <libtu/ptrvec.h>
 #include <libextl/extl.h>
 #include <ioncore/common.h>
 #include <ioncore/region.h>
@@ -26,7 +26,7 @@ DECLCLASS(WTiling){
     WRegion reg;
     WSplit *split_tree;
     WSplitST *stdispnode;
-    PtrList *managed_list;
+    PtrVec managed_list;
     WRegionSimpleCreateFn *create_frame_fn;
     Window dummywin;
     bool batchop;
@@ -115,13 +115,13 @@ extern WSplit *load_splitst(WTiling *ws, const WRectangle *geom, ExtlTab tab);
 
 /* Iteration */
 
-typedef PtrListIterTmp WTilingIterTmp;
+typedef PtrVecIterTmp WTilingIterTmp;
 
 #define FOR_ALL_MANAGED_BY_TILING(VAR, WS, TMP) \
-    FOR_ALL_ON_PTRLIST(WRegion*, VAR, (WS)->managed_list, TMP)
+    FOR_ALL_ON_PTRVEC(WRegion*, VAR, &(WS)->managed_list, TMP)
 
 #define FOR_ALL_MANAGED_BY_TILING_UNSAFE(VAR, WS) \
-    FOR_ALL_ON_PTRLIST_UNSAFE(WRegion*, VAR, (WS)->managed_list)
+    FOR_ALL_ON_PTRVEC_UNSAFE(WRegion*, VAR, &(WS)->managed_list)
 
 /* Misc. */
 
@@ -82,16 +82,17 @@ static bool docall(ExtlFn fn, ExtlTab t)
     return ret;
 }
 
-#define MRSH_ANY(PRM,TAB)                                      \
-    extl_table_sets_b(TAB, "send_event", PRM->any.send_event); \
-    extl_table_sets_i(TAB, "time", PRM->any.time);             \
-    extl_table_sets_i(TAB, "device", PRM->any.device)
+/* The arguments are variadic, so the 'i' fields must be cast to int. */
+#define MRSH_ANY_SPEC "bii"
+#define MRSH_ANY(PRM)                            \
+    "send_event", PRM->any.send_event,           \
+    "time", (int)PRM->any.time,                  \
+    "device", (int)PRM->any.device
 
 static bool mrsh_group_extl(ExtlFn fn, WGroupParams *param)
 {
-    ExtlTab t=extl_create_table();
+    ExtlTab t=extl_create_table_with(MRSH_ANY_SPEC, MRSH_ANY(param));
 
-    MRSH_ANY(param,t);
     if(param->group!=-1)
         extl_table_sets_i(t, "group", param->group + 1);
     if(param->base_group!=-1)
@@ -106,25 +107,20 @@ static bool mrsh_group_extl(ExtlFn fn, WGroupParams *param)
 
 static bool mrsh_bell_extl(ExtlFn fn, WBellParams *param)
 {
-    ExtlTab t=extl_create_table();
-
-    MRSH_ANY(param,t);
-    extl_table_sets_i(t, "percent", param->percent);
-    extl_table_sets_i(t, "pitch", param->pitch);
-    extl_table_sets_i(t, "duration", param->duration);
-
-    extl_table_sets_i(t, "bell_class", param->bell_class);
-    extl_table_sets_i(t, "bell_id", param->bell_id);
-
-    if(param->name){
-        extl_table_sets_s(t, "name", param->name);
+    /* A NULL name or window leaves the field unset. */
+    ExtlTab t=extl_create_table_with(MRSH_ANY_SPEC "iiiiisob",
+                                     MRSH_ANY(param),
+                                     "percent", param->percent,
+                                     "pitch", param->pitch,
+                                     "duration", param->duration,
+                                     "bell_class", (int)param->bell_class,
+                                     "bell_id", (int)param->bell_id,
+                                     "name", param->name,
+                                     "window", (Obj*)param->window,
+                                     "event_only", param->event_only);
+
+    if(param->name)
         free(param->name);
-    }
-
-    if(param->window)
-        extl_table_sets_o(t, "window", (Obj*)param->window);
-
-    extl_table_sets_b(t, "event_only", param->event_only);
 
     return docall(fn, t);
 }